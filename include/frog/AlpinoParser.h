@@ -37,6 +37,7 @@
 #include <set>
 #include <libxml/tree.h>
 #include "frog/Parser.h"
+#include "frog/alpino_pool.h"
 
 class frog_data;
 
@@ -65,12 +66,15 @@ class AlpinoParser: public ParserBase {
  public:
   explicit AlpinoParser( TiCC::LogStream* errlog, TiCC::LogStream* dbglog ):
   ParserBase( errlog, dbglog ),
-    _alpino_server(false)
+    _alpino_server(false),
+    pool(0)
       {};
+  ~AlpinoParser() override;
   bool init( const TiCC::Configuration& ) override;
   void add_provenance( folia::Document& doc,
 		       folia::processor * ) const override;
   void Parse( frog_data&, TimerBlock& ) override;
+  bool thread_safe() const override { return true; };
   void add_result( const frog_data&,
 		   const std::vector<folia::Word*>& ) const override;
   void add_mwus( const frog_data&,
@@ -79,6 +83,7 @@ class AlpinoParser: public ParserBase {
   std::vector<parsrel> alpino_parse( frog_data& );
   std::vector<parsrel> alpino_server_parse( frog_data& );
   bool _alpino_server;
+  AlpinoPool *pool; ///< the local Alpino processes (when not using a server)
   AlpinoParser( const AlpinoParser& ) = delete; // inhibit copies
   AlpinoParser operator=( const AlpinoParser& ) = delete; // inhibit copies
 };
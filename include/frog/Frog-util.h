@@ -83,6 +83,23 @@ public:
     csiTimer.reset();
     frogTimer.reset();
   }
+  void add( const TimerBlock& tb ){
+    /// accumulate the timings of another TimerBlock into this one
+    parseTimer = parseTimer + tb.parseTimer;
+    tokTimer = tokTimer + tb.tokTimer;
+    mblemTimer = mblemTimer + tb.mblemTimer;
+    mbmaTimer = mbmaTimer + tb.mbmaTimer;
+    mwuTimer = mwuTimer + tb.mwuTimer;
+    tagTimer = tagTimer + tb.tagTimer;
+    iobTimer = iobTimer + tb.iobTimer;
+    nerTimer = nerTimer + tb.nerTimer;
+    prepareTimer = prepareTimer + tb.prepareTimer;
+    pairsTimer = pairsTimer + tb.pairsTimer;
+    relsTimer = relsTimer + tb.relsTimer;
+    dirTimer = dirTimer + tb.dirTimer;
+    csiTimer = csiTimer + tb.csiTimer;
+    frogTimer = frogTimer + tb.frogTimer;
+  }
 };
 
 #endif
@@ -32,6 +32,11 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <functional>
+#include <mutex>
+#include <future>
+#include <chrono>
 
 #include "timbl/TimblAPI.h"
 
@@ -45,15 +50,19 @@
 
 #include "frog/Frog-util.h"
 #include "frog/FrogData.h"
+#include "frog/frog_stats.h"
 
 class UctoTokenizer;
 class Mbma;
+class MbmaContext;
 class Mblem;
+class MblemContext;
 class Mwu;
 class ParserBase;
 class CGNTagger;
 class IOBTagger;
 class NERTagger;
+class SentencePipeline;
 
 /// \brief this class holds the runtime settings for Frog
 class FrogOptions {
@@ -93,6 +102,11 @@ class FrogOptions {
   bool doServer;             ///< do we want to run as a server?
   /*!< currently only TCP servers are supported
    */
+  bool serverStream;         ///< send server results per sentence?
+  /*!< when TRUE, the server sends the result of every sentence as soon as
+    it is frogged, instead of the complete result at the end of a request.
+    Not possible for FoLiA.
+   */
   bool doKanon;              ///< do we want FoLiA to be output in a canonical way?
   /*!< This can be conveniant for testing purposes as it makes sure that nodes
     from several modules are always in the same order in the XML
@@ -106,6 +120,11 @@ class FrogOptions {
     but it may be usefull to skip that
   */
   bool interactive;         ///< are we running from the command line?
+  bool lazyInit;            ///< load the modules in the background?
+  /*!< when TRUE, only the tokenizer and the tagger are loaded before we
+    start. Frogging a sentence waits for the other modules it needs.
+    Not used with fork()ing (server mode or more than 1 process)
+   */
   bool doAlpinoServer;      ///< should we try to connect to an Alpino server?
   /*!< this assumes that an Alpino Server is set up and running and that it's
     location is configured correctly.
@@ -117,6 +136,15 @@ class FrogOptions {
   bool do_und_language;     ///< should the tokenizer handle 'und'?
   bool do_language_detection;  ///< should the tokenizer detect more languages?
   int numThreads;           ///< limit for the number of threads
+  int numWorkers;           ///< the number of sentence workers
+  /*!< When > 1, the tokenizer feeds a bounded queue of sentences which
+    are frogged concurrently by this many workers. The results are delivered
+    in the original order.
+   */
+  int numProcesses;         ///< the number of input files frogged at once
+  /*!< When > 1, this many forked processes share the input files. They all
+    use the models loaded once by the main process.
+   */
   int debugFlag;            ///< value for the generic debug level
   /*!< This value is used as the debug level for EVERY module.
     It is however possible to set specific levels per module too.
@@ -132,6 +160,16 @@ of input encodings. The default is UTF8. The output will always be in UTF8.
    */
   std::string uttmark;     ///< the string which separates Utterances
   std::string listenport;  ///< determines the port to run the Frog Server on
+  int serverWorkers;       ///< the number of preforked server processes
+  /*!< 0 means: fork a new process for every connection
+   */
+  int serverBacklog;       ///< the maximum number of queued connections
+  int serverMaxRequests;   ///< recycle a server process after this many
+                           ///< connections. 0 means never
+  int serverParallelMin;   ///< the minimal size (in bytes) of a server
+                           ///< request to frog it with several workers
+  std::string mwuImage;    ///< compile the MWU file into this image and stop
+  std::string statsFile;   ///< write the statistics as JSON to this file
   std::string docid;       ///< the FoLiA document ID on output.
   std::string inputclass;  ///< the textclass to use on FoLiA input
   std::string outputclass; ///< the textclass to use on FoLiA output
@@ -173,6 +211,26 @@ maximum of 500 words PER SENTENC. Which is already a lot!
   FrogOptions( const FrogOptions & ) = delete;
 };
 
+/// \brief the private state of one thread that frogs sentences
+class worker_context {
+ public:
+  worker_context( const Mbma *, const Mblem * );
+  ~worker_context();
+  TimerBlock timers;        ///< the timers for this worker
+  MbmaContext *mbma;        ///< the scratch space for MBMA (or 0)
+  MblemContext *mblem;      ///< the scratch space for MBLEM (or 0)
+  worker_context( const worker_context& ) = delete;
+  worker_context& operator=( const worker_context& ) = delete;
+};
+
+/// \brief the input and output file names for one input file
+struct file_job {
+  std::string name;        ///< the name as given on the command line
+  std::string testName;    ///< the input file
+  std::string outName;     ///< the output file for tabbed or JSON output
+  std::string xmlOutName;  ///< the output file for FoLiA
+};
+
 /// \brief This is the API class which can be used to set up Frog and run it
 /// on files, strings, TCP sockets or a terminal.
 class FrogAPI {
@@ -186,6 +244,9 @@ class FrogAPI {
   bool run_a_server();
   void run_interactive();
   void run_api_tests( const std::string& );
+  nlohmann::json stats_json() const;
+  void write_stats() const;
+  void reset_stats();
   std::string Frogtostring( const std::string& );
   std::string Frogtostringfromfile( const std::string& );
   static std::string defaultConfigFile( const std::string& ="" );
@@ -196,13 +257,46 @@ class FrogAPI {
 			TiCC::Configuration&,
 			TiCC::LogStream* );
   folia::Document *FrogFile( const std::string& );
+  bool prepare_file_job( const std::string&, file_job& ) const;
+  bool frog_file_job( const file_job& );
+  void run_files_parallel( const std::vector<file_job>& );
   void FrogServer( Sockets::ClientSocket &conn );
+  void stream_text( Sockets::ClientSocket &conn, std::ostringstream&,
+		    const std::string& = "" );
+  bool init_tokenizer( const TiCC::Configuration& );
+  bool init_tagger( const TiCC::Configuration& );
+  bool init_lemmatizer( const TiCC::Configuration& );
+  bool init_mbma( const TiCC::Configuration& );
+  bool init_iob( const TiCC::Configuration& );
+  bool init_ner( const TiCC::Configuration& );
+  bool init_mwu( const TiCC::Configuration& );
+  bool init_parser( const TiCC::Configuration& );
+  void start_lazy_init( const TiCC::Configuration& );
+  void wait_for( const std::shared_future<void>& ) const;
+  void wait_for_modules() const;
+  void join_loaders();
+  void run_preforked_server( Sockets::ServerSocket& );
+  void server_worker( Sockets::ServerSocket&, int );
 
   frog_data frog_sentence( std::vector<Tokenizer::Token>&,
 			   const size_t,
 			   bool=false );
+  void frog_one_sentence( frog_data&,
+			  const size_t,
+			  worker_context& );
+  void dispatch_sentence( frog_data&&,
+			  const size_t,
+			  const std::function<void(frog_data&)>& );
+  void start_pipeline();
+  void finish_pipeline();
+  void stop_pipeline();
+  void collect_timers();
+  void show_timers( const TimerBlock&, bool ) const;
+  void add_stat( FrogStats::stage,
+		 const std::chrono::steady_clock::time_point& ) const;
   folia::Document *run_folia_engine( const std::string&,
-				     std::ostream& );
+				     std::ostream&,
+				     bool = false );
   folia::Document *run_text_engine( const std::string&,
 				    std::ostream& );
   folia::FoliaElement* start_document( const std::string&,
@@ -210,6 +304,8 @@ class FrogAPI {
   folia::FoliaElement *append_to_folia( folia::FoliaElement *,
 					const frog_data&,
 					unsigned int& ) const;
+  void append_sentences( folia::FoliaElement *,
+			 const std::vector<frog_data>& ) const;
   void add_ner_result( folia::Sentence *,
 		       const frog_data&,
 		       const std::vector<folia::Word*>& ) const;
@@ -230,7 +326,8 @@ class FrogAPI {
 		      const frog_record& ) const;
   void output_JSON( std::ostream& os,
 		    const frog_data& fd,
-		    int = 0 ) const;
+		    int = 0,
+		    const nlohmann::json * = 0 ) const;
   void show_results( std::ostream&,
 		     const frog_data& ) const;
   void handle_one_paragraph( std::ostream&,
@@ -256,6 +353,7 @@ class FrogAPI {
   TiCC::LogStream *theErrLog;               ///< the stream to send errors to
   TiCC::LogStream *theDbgLog;               ///< the stream to send debug info
   TimerBlock timers;                        ///< all runtime timers
+  FrogStats *stats;         ///< the statistics, shared with forked processes
   Mbma *myMbma;             ///< pointer to the MBMA module
   Mblem *myMblem;           ///< pointer to the MBLEM module
   Mwu *myMwu;               ///< pointer to the MWU module
@@ -264,6 +362,18 @@ class FrogAPI {
   IOBTagger *myIOBTagger;   ///< pointer to the IOB chunker
   NERTagger *myNERTagger;   ///< pointer to the NER
   UctoTokenizer *tokenizer; ///< pointer to the Ucot tokenizer
+  std::vector<worker_context*> contexts; ///< one context per worker
+  SentencePipeline *pipeline; ///< the active sentence pipeline (if any)
+  bool serial_only;         ///< when true, start_pipeline() does nothing
+  std::mutex mwu_lock;      ///< serializes the MWU resolver between workers
+  std::mutex parser_lock;   ///< serializes a non thread safe parser
+  // the background loaders of the modules, only valid with lazy init
+  std::shared_future<void> mblem_loader;  ///< loads the lemmatizer
+  std::shared_future<void> mbma_loader;   ///< loads MBMA
+  std::shared_future<void> iob_loader;    ///< loads the IOB chunker
+  std::shared_future<void> ner_loader;    ///< loads the NER
+  std::shared_future<void> mwu_loader;    ///< loads the MWU module
+  std::shared_future<void> parser_loader; ///< loads the parser
 };
 
 std::vector<std::string> get_full_morph_analysis( folia::Word *word,
@@ -44,10 +44,28 @@
 #include "frog/FrogData.h"
 #include "frog/ckyparser.h" // only for struct parsrel....
 
-struct parseData;
 class TimerBlock;
 class timbl_result;
 
+/// \brief the words, heads and modifiers of a sentence, as input for the
+/// parser's Timbl classifiers
+struct parseData {
+  void clear() { words.clear(); heads.clear(); mods.clear(); mwus.clear(); }
+  /// the word at position \e i, or "__" when \e i is outside the sentence
+  const icu::UnicodeString& word( int i ) const { return feature( words, i ); }
+  /// the head at position \e i, or "__" when \e i is outside the sentence
+  const icu::UnicodeString& head( int i ) const { return feature( heads, i ); }
+  /// the mods at position \e i, or "__" when \e i is outside the sentence
+  const icu::UnicodeString& mod( int i ) const { return feature( mods, i ); }
+  std::vector<icu::UnicodeString> words;
+  std::vector<icu::UnicodeString> heads;
+  std::vector<icu::UnicodeString> mods;
+  std::vector<std::vector<folia::Word*> > mwus;
+private:
+  static const icu::UnicodeString& feature( const std::vector<icu::UnicodeString>&,
+					    int );
+};
+
 /// \brief a virtual base class to add parser functionality. Needs specializions
 /// for e.g running a CKY parser or Alpino
 class ParserBase {
@@ -66,6 +84,8 @@ class ParserBase {
   virtual void add_provenance( folia::Document& doc,
 			       folia::processor * ) const =0;
   virtual void Parse( frog_data&, TimerBlock& ) = 0;
+  /// may Parse() be called from several threads at the same time?
+  virtual bool thread_safe() const { return false; };
   virtual void add_result( const frog_data&,
 			   const std::vector<folia::Word*>& ) const;
   std::vector<std::string> createParserInstances( const parseData& );
@@ -93,9 +113,13 @@ public:
   explicit Parser( TiCC::LogStream* errlog, TiCC::LogStream* dbglog ):
     ParserBase( errlog, dbglog ),
     maxDepSpan( 0 ),
+    boundedMin( 0 ),
+    parallelMin( 200 ),
+    numThreads( 1 ),
     pairs(0),
     dir(0),
-    rels(0) {};
+    rels(0),
+    debug(false) {};
   ~Parser() override;
   bool init( const TiCC::Configuration& ) override;
   void add_provenance( folia::Document& doc,
@@ -103,9 +127,6 @@ public:
   parseData prepareParse( frog_data& );
   void Parse( frog_data&, TimerBlock& ) override;
  private:
-  std::vector<icu::UnicodeString> createPairInstances( const parseData& );
-  std::vector<icu::UnicodeString> createDirInstances( const parseData& );
-  std::vector<icu::UnicodeString> createRelInstances( const parseData& );
   std::vector<timbl_result> timbl_server( const std::string&,
 					  const std::vector<icu::UnicodeString>& );
   std::vector<timbl_result> timbl( Timbl::TimblAPI *,
@@ -114,14 +135,28 @@ public:
   Parser operator=( const Parser& ) = delete; // inhibit copies
   std::string maxDepSpanS;
   size_t maxDepSpan;
+  /// decode sentences of at least this many tokens with edges of at most
+  /// maxDepSpan tokens (and any length from the root). This may change
+  /// the parse. 0: never
+  size_t boundedMin;
+  /// decode sentences of at least this many tokens with numThreads OpenMP
+  /// threads. 0: never
+  size_t parallelMin;
+  int numThreads;  ///< the size of the OpenMP team, from --threads
   Timbl::TimblAPI *pairs;
   Timbl::TimblAPI *dir;
   Timbl::TimblAPI *rels;
   std::string _pairs_base;
   std::string _dirs_base;
   std::string _rels_base;
+  bool debug;
 };
 
+std::vector<icu::UnicodeString> createPairInstances( const parseData&,
+						     size_t );
+std::vector<icu::UnicodeString> createDirInstances( const parseData& );
+std::vector<icu::UnicodeString> createRelInstances( const parseData& );
+
 void appendParseResult( frog_data& fd,
 			const std::vector<parsrel>& res );
 #endif
@@ -0,0 +1,95 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#ifndef ALPINO_POOL_H
+#define ALPINO_POOL_H
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+
+/// \brief one long running Alpino process.
+///
+/// The process reads sentences on its standard input, one per line, and
+/// writes an Alpino XML document for every sentence on its standard output.
+class AlpinoWorker {
+ public:
+  explicit AlpinoWorker( const std::vector<std::string>& );
+  ~AlpinoWorker();
+  bool start( std::string& );
+  bool parse( const std::string&, int, std::string& );
+  void stop();
+  void abandon();
+  bool running() const { return pid > 0; };
+  AlpinoWorker( const AlpinoWorker& ) = delete;
+  AlpinoWorker& operator=( const AlpinoWorker& ) = delete;
+ private:
+  bool read_line( std::string&, const std::chrono::steady_clock::time_point& );
+  std::vector<std::string> command;
+  pid_t pid;
+  int sock;            ///< our end of the connection with the process
+  std::string buffer;  ///< output read, but not yet used
+  size_t counter;      ///< to give every sentence a unique key
+};
+
+/// \brief a limited set of long running Alpino processes.
+///
+/// Workers are started when needed, up to a maximum. A worker that crashes
+/// or hangs is stopped and replaced by a new one.
+class AlpinoPool {
+ public:
+  AlpinoPool( const std::string&, size_t, int );
+  ~AlpinoPool();
+  std::string parse( const std::string& );
+  size_t max_workers() const { return _max_workers; };
+  size_t restarts() const { return _restarts; };
+  AlpinoPool( const AlpinoPool& ) = delete;
+  AlpinoPool& operator=( const AlpinoPool& ) = delete;
+ private:
+  std::unique_ptr<AlpinoWorker> acquire();
+  void release( std::unique_ptr<AlpinoWorker>, bool );
+  std::vector<std::string> command;
+  size_t _max_workers;
+  int _timeout;
+  std::mutex pool_lock;
+  std::condition_variable pool_cv;
+  std::vector<std::unique_ptr<AlpinoWorker>> idle;
+  size_t busy;       ///< the number of workers in use
+  size_t _restarts;  ///< the number of workers we had to replace
+  pid_t owner;       ///< the process that started the workers
+};
+
+#endif // ALPINO_POOL_H
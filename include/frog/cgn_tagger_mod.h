@@ -42,7 +42,8 @@ class CGNTagger: public BaseTagger {
   BaseTagger( l, d, "tagger" ){};
   bool init( const TiCC::Configuration& ) override;
   void add_declaration( folia::Document&, folia::processor * ) const override;
-  void post_process( frog_data& ) override;
+  void post_process( frog_data&,
+		     const std::vector<Tagger::TagResult>& ) override;
   void add_tags( const std::vector<folia::Word*>&,
 		 const frog_data& ) const;
   std::string getSubSet( const std::string& ,
@@ -32,107 +32,76 @@
 #define CKYPARSER_H
 
 #include <cstdlib>
+#include <cstdint>
 #include <string>
 #include <set>
 #include <vector>
+#include <unordered_map>
 #include <ostream>
 #include "ticcutils/LogStream.h"
 
-enum dirType { ROOT, LEFT, RIGHT, ERROR };
+enum dirType : uint8_t { ROOT, LEFT, RIGHT, ERROR };
 
-/// \brief base class to hold parse constraints
-class Constraint {
- public:
-  enum ConstraintType { Incoming, Dependency, Direction };
-  Constraint( double w, int i ): weight(w),tokenIndex(i){
-  };
-  virtual ~Constraint(){};
-  virtual void put( std::ostream& os ) const {
-    os << tokenIndex << " " << weight;
-  };
-  virtual ConstraintType type() const = 0;
-  virtual dirType direct() const { return ERROR; };
-  virtual std::string rel() const { return "NOREL"; };
-  virtual int hIndex() const { abort(); };
-  int tIndex() const { return tokenIndex; };
-  double wght() const { return weight; };
- protected:
+/// \brief one parse constraint, as kept in a ConstraintStore
+struct wcsp_constraint {
+  enum ConstraintType : uint8_t { Incoming, Dependency, Direction };
   double weight;
-  int    tokenIndex;
+  int token;           ///< the token the constraint is about
+  int head;            ///< the head of the token. (Dependency only)
+  int rel;             ///< the relation, see ConstraintStore::relation()
+  ConstraintType type;
+  dirType direction;   ///< the direction of the head. (Direction only)
 };
 
-std::ostream& operator<<( std::ostream& os, const Constraint& c );
-std::ostream& operator<<( std::ostream& os, const Constraint* c );
-
-/// \brief specialization of Constraint to hold a relation
-class HasIncomingRel: public Constraint {
+/// \brief all parse constraints of one sentence
+/*!
+  The constraints are kept in one flat array, and the relations are
+  interned, so building and destroying the constraints of a sentence
+  costs a handful of allocations.
+ */
+class ConstraintStore {
  public:
- HasIncomingRel( int i, const std::string& r, double w ):
-  Constraint( w, i ), relType(r){
+  /// the labels every parse needs, they have these fixed ids
+  enum fixed_label { NONE_LABEL, ROOT_LABEL, UNSET_LABEL, EMPTY_LABEL };
+  explicit ConstraintStore( size_t = 0 );
+  void add_dependency( int, int, const std::string&, double );
+  void add_incoming( int, const std::string&, double );
+  void add_direction( int, const std::string&, double );
+  size_t size() const { return constraints.size(); };
+  std::vector<wcsp_constraint>::const_iterator begin() const {
+    return constraints.begin();
   };
-  void put( std::ostream& ) const override;
-  ConstraintType type() const override { return Incoming; }
-  std::string rel() const override { return relType; };
- private:
-  std::string relType;
-};
-
-/// \brief specialization of Constraint to hold a dependency
-class HasDependency: public Constraint {
- public:
- HasDependency( int i, int h, const std::string& r, double w ):
-  Constraint( w, i ), relType(r), headType(h) {
-    };
-  void put( std::ostream& ) const override;
-  ConstraintType type() const override { return Dependency; };
-  int hIndex() const override { return headType; };
-  std::string rel() const override { return relType; };
+  std::vector<wcsp_constraint>::const_iterator end() const {
+    return constraints.end();
+  };
+  int relations() const { return relation_names.size(); };
+  const std::string& relation( int id ) const { return relation_names[id]; };
+  std::string to_string( const wcsp_constraint& ) const;
  private:
-  std::string relType;
-  int headType;
+  int intern( const std::string& );
+  std::vector<wcsp_constraint> constraints;
+  std::vector<std::string> relation_names;
+  std::unordered_map<std::string,int> relation_ids;
 };
 
-/// \brief specialization of Constraint to hold the direction of a Dependency
-class DependencyDirection: public Constraint {
- public:
- DependencyDirection( int i, const std::string& d, double w ):
-  Constraint( w, i ), direction(toEnum(d)){
-  }
-  void put( std::ostream& ) const override;
-  ConstraintType type() const override { return Direction; };
-  dirType direct() const override { return direction; };
- private:
-  dirType toEnum( const std::string& s ){
-    if ( s == "ROOT" )
-      return ROOT;
-    else if ( s == "LEFT" )
-      return LEFT;
-    else if ( s == "RIGHT" )
-      return RIGHT;
-    else {
-      abort();
-    }
-  }
-  dirType direction;
-};
+std::ostream& operator<<( std::ostream&, const ConstraintStore& );
 
 /// \brief structure to hold best fit so far
 class SubTree {
  public:
- SubTree( double score, int r, const std::string& label ):
+ SubTree( double score, int r, int label ):
   _score( score ), _r( r ), _edgeLabel( label ){
   }
  SubTree( ):
-  _score( 0.0 ), _r( -1 ), _edgeLabel( "" ){
+  _score( 0.0 ), _r( -1 ), _edgeLabel( -1 ){
   }
-  std::set<const Constraint*>  satisfiedConstraints;
   double score() const { return _score; };
   int r() const { return _r; };
-  const std::string& edgeLabel() const { return _edgeLabel; };
+  int edgeLabel() const { return _edgeLabel; };
  private:
   double _score;
   int _r;
-  std::string _edgeLabel;
+  int _edgeLabel; ///< see ConstraintStore::relation()
 };
 
 /// \brief helper structure to hold a head and a relation
@@ -150,28 +119,65 @@ class chart_rec {
   SubTree r_False;
 };
 
+/// \brief a constraint as the CKYParser uses it
+struct cky_constraint {
+  const wcsp_constraint *c;
+  double weight;
+  int label;   ///< the relation
+  dirType dir;
+  int bit;     ///< the bit in the satisfied sets of its token. -1 when unused
+};
+
 /// \brief The class that can run the parser
 class CKYParser {
 public:
   CKYParser( size_t,
-	     const std::vector<const Constraint*>&,
-	     const TiCC::LogStream* );
+	     const ConstraintStore&,
+	     const TiCC::LogStream*,
+	     size_t = 0,
+	     bool = false );
   ~CKYParser(){ delete ckyLog; };
-  void parse();
+  void parse( int = 1 );
   void leftIncomplete( int , int , std::vector<parsrel>& );
   void rightIncomplete( int , int , std::vector<parsrel>& );
   void leftComplete( int , int , std::vector<parsrel>& );
   void rightComplete( int , int , std::vector<parsrel>& );
 
 private:
-  void addConstraint( const Constraint * );
-  std::string bestEdge( const SubTree& , const SubTree& , size_t , size_t,
-			std::set<const Constraint*>&, double& );
+  /// the 4 SubTrees in a chart_rec, to address their satisfied sets
+  enum sub_tree { L_TRUE, L_FALSE, R_TRUE, R_FALSE };
+  void addConstraint( const wcsp_constraint& );
+  size_t index( size_t s, size_t t ) const {
+    // the chart only holds the cells with s <= t, row by row
+    return s*(2*numTokens+3-s)/2 + t - s;
+  };
+  chart_rec& cell( size_t s, size_t t ){
+    return chart[index( s, t )];
+  };
+  uint64_t *satisfied( size_t s, size_t t, sub_tree st ){
+    return &satisfiedBits[(index( s, t )*4+st)*numWords];
+  };
+  const std::vector<cky_constraint>& edges( size_t, size_t ) const;
+  void set_satisfied( size_t, size_t, sub_tree,
+		      const uint64_t *,
+		      const std::vector<int>& );
+  int bestEdge( const uint64_t *, size_t , size_t,
+		std::vector<int>&, std::vector<int>&, double& ) const;
+  void fill_cell( size_t, size_t, bool,
+		  std::vector<int>&, std::vector<int>&, std::vector<int>& );
   size_t numTokens;
-  std::vector< std::vector<const Constraint*>> inDepConstraints;
-  std::vector< std::vector<const Constraint*>> outDepConstraints;
-  std::vector< std::vector< std::vector<const Constraint*>>> edgeConstraints;
-  std::vector< std::vector<chart_rec>> chart;
+  size_t maxSpan;    ///< the longest edge to consider. 0 means no limit
+  size_t edgeWidth;  ///< the longest edge with a Dependency constraint
+  size_t numWords;   ///< the number of words in one satisfied set
+  std::vector< std::vector<cky_constraint>> inDepConstraints;
+  std::vector< std::vector<cky_constraint>> outDepConstraints;
+  std::vector< std::vector<cky_constraint>> rootConstraints;
+  std::vector< std::vector<cky_constraint>> edgeConstraints;
+  std::vector<chart_rec> chart;
+  /// the satisfied constraints of all SubTrees in the chart, as bitsets
+  std::vector<uint64_t> satisfiedBits;
+  const ConstraintStore& store;
+  bool debug;
 
   TiCC::LogStream *ckyLog;
 
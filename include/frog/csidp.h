@@ -73,11 +73,20 @@ private:
 };
 
 
+/// \brief how to run the CKY decoding of one sentence
+struct cky_options {
+  bool bounded = false;  ///< ignore edges longer than maxDist (but from root)
+  int threads = 1;       ///< fill the chart with a team of this many
+                         ///< OpenMP threads. 1: no team
+  bool debug = false;    ///< log every step of the decoding
+};
+
 std::vector<parsrel> parse( const std::vector<timbl_result>& p_res,
 			    const std::vector<timbl_result>& r_res,
 			    const std::vector<timbl_result>& d_res,
 			    size_t sent_len,
 			    int maxDist,
-			    TiCC::LogStream *dbg_log );
+			    TiCC::LogStream *dbg_log,
+			    const cky_options& = cky_options() );
 
 #endif
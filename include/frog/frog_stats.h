@@ -0,0 +1,89 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#ifndef FROG_STATS_H
+#define FROG_STATS_H
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include "ticcutils/json.hpp"
+
+/// \brief the latency distribution of one processing stage
+///
+/// Latencies are counted in buckets on a logarithmic scale, with 4 buckets
+/// per power of 2 microseconds. So percentiles are accurate to about 20%.
+struct stage_stats {
+  static const int NUM_BUCKETS = 8 + 4*40;
+  std::atomic<uint64_t> count;     ///< the number of measurements
+  std::atomic<uint64_t> total_us;  ///< the sum of all measurements
+  std::atomic<uint64_t> max_us;    ///< the largest measurement
+  std::atomic<uint64_t> buckets[NUM_BUCKETS]; ///< the distribution
+  void add( uint64_t );
+  uint64_t percentile( double ) const;
+  nlohmann::json to_json() const;
+  void reset();
+};
+
+/// \brief runtime statistics of Frog: latencies per stage and per sentence,
+/// throughput and the distribution of sentence lengths.
+///
+/// All counters are lock-free atomics, and a FrogStats is created in an
+/// anonymous shared memory mapping. So all worker threads, AND all
+/// processes fork()ed after its creation (server processes, --processes)
+/// update the same counters without any locking.
+class FrogStats {
+ public:
+  /// the measured stages. SENTENCE is the whole frogging of a sentence
+  enum stage { TAGGER, MBLEM, MBMA, NER, IOB, MWU, PARSER, SENTENCE,
+	       NUM_STAGES };
+  static FrogStats *create();
+  static void destroy( FrogStats * );
+  void add( stage s, uint64_t us ){ stages[s].add( us ); };
+  void add_sentence( size_t, uint64_t );
+  nlohmann::json to_json() const;
+  void reset();
+  static const char *stage_name( stage );
+ private:
+  FrogStats();
+  ~FrogStats(){};
+  FrogStats( const FrogStats& ) = delete;
+  FrogStats& operator=( const FrogStats& ) = delete;
+  static const int LENGTH_STEP = 5;
+  static const int NUM_LENGTHS = 21; ///< the last one is for longer sentences
+  std::atomic<int64_t> start;       ///< when we started counting (seconds)
+  std::atomic<uint64_t> tokens;     ///< the number of frogged tokens
+  std::atomic<uint64_t> lengths[NUM_LENGTHS]; ///< sentences per length
+  stage_stats stages[NUM_STAGES];
+};
+
+#endif // FROG_STATS_H
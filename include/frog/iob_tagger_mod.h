@@ -42,7 +42,8 @@ class IOBTagger: public BaseTagger {
   bool init( const TiCC::Configuration& ) override;
   void add_declaration( folia::Document&, folia::processor * ) const override;
   void Classify( frog_data& ) override;
-  void post_process( frog_data& ) override;
+  void post_process( frog_data&,
+		     const std::vector<Tagger::TagResult>& ) override;
   void add_result( const frog_data& fd,
 		   const std::vector<folia::Word*>& wv ) const;
  private:
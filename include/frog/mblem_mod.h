@@ -38,6 +38,7 @@
 #include "ticcutils/Unicode.h"
 #include "timbl/TimblAPI.h"
 #include "frog/FrogData.h"
+#include "frog/result_cache.h"
 
 /// \brief Helper class for Mblem. A datastructure to hold lemma/tag information
 class mblemData {
@@ -52,6 +53,23 @@ private:
   icu::UnicodeString tag;
 };
 
+/// \brief the private (per thread) state of an Mblem lemmatization
+///
+/// The Mblem class only holds the shared, read-only model. The results for
+/// the current word live in an MblemContext, one for every thread.
+class MblemContext {
+ public:
+  explicit MblemContext( const Timbl::TimblAPI * );
+  ~MblemContext();
+  Timbl::TimblAPI *lex;                ///< a private child of the shared tree
+  std::vector<mblemData> mblemResult;  ///< the results for the current word
+  /// the classes for the instances of the current sentence, as fetched from
+  /// a Timbl server in one request
+  std::map<icu::UnicodeString,icu::UnicodeString> remote_classes;
+  MblemContext( const MblemContext& ) = delete;
+  MblemContext& operator=( const MblemContext& ) = delete;
+};
+
 /// \brief provide all functionality to run a Timbl for lemmatization
 class Mblem {
  public:
@@ -59,32 +77,49 @@ class Mblem {
   ~Mblem();
   bool init( const TiCC::Configuration& );
   void add_provenance( folia::Document&, folia::processor * ) const;
+  MblemContext *create_context() const;
   void Classify( frog_record& );
+  void Classify( frog_record&, MblemContext& ) const;
+  void Classify( frog_data& );
+  void Classify( frog_data&, MblemContext& ) const;
   void Classify( const icu::UnicodeString& );
+  void Classify( const icu::UnicodeString&, MblemContext& ) const;
   std::vector<std::pair<icu::UnicodeString,icu::UnicodeString> > getResult() const;
+  std::vector<std::pair<icu::UnicodeString,icu::UnicodeString> > getResult( const MblemContext& ) const;
   const std::string& getTagset() const { return tagset; };
   const std::string& version() const { return _version; };
   void filterTag( const icu::UnicodeString& );
+  void filterTag( const icu::UnicodeString&, MblemContext& ) const;
   void makeUnique();
+  void makeUnique( MblemContext& ) const;
   void add_lemmas( const std::vector<folia::Word*>&,
 		   const frog_data& ) const;
+  std::string cache_stats() const;
+  bool cache_counts( size_t&, size_t& ) const;
+  void reset_cache_counts();
   TiCC::UnicodeNormalizer& normalizer(){ return _normalizer; };
  private:
-  icu::UnicodeString call_server( const icu::UnicodeString& );
+  icu::UnicodeString call_server( const icu::UnicodeString& ) const;
+  std::vector<icu::UnicodeString> call_server( const std::vector<icu::UnicodeString>& ) const;
+  void prefetch( const frog_data&, MblemContext& ) const;
+  bool special_lemma( const frog_record&,
+		      const icu::UnicodeString&,
+		      icu::UnicodeString& ) const;
   void read_transtable( const std::string& );
   void create_MBlem_defaults();
   bool readsettings( const std::string& dir, const std::string& fname );
   bool fill_ts_map( const std::string& );
   bool fill_eq_set( const std::string& );
-  icu::UnicodeString make_instance( const icu::UnicodeString& in );
+  icu::UnicodeString make_instance( const icu::UnicodeString& in ) const;
   Timbl::TimblAPI *myLex;
+  MblemContext *default_context; ///< used by the single threaded interface
+  ResultCache<std::vector<icu::UnicodeString>> *cache; ///< lemmas of frequent words (or 0)
   std::string punctuation;
   size_t history;
   int debug;
   bool keep_case;
   std::map<icu::UnicodeString, std::map<icu::UnicodeString, int>> token_strip_map;
   std::set<icu::UnicodeString> one_one_tags;
-  std::vector<mblemData> mblemResult;
   std::string _version;
   std::string tagset;
   std::string POS_tagset;
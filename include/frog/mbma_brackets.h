@@ -93,6 +93,7 @@ class BaseBracket {
     _normalizer(norm)
   {};
   virtual ~BaseBracket() {};
+  virtual BaseBracket *clone() const = 0;
   Status status() const { return _status; };
   void set_status( const Status s ) { _status = s; };
   virtual icu::UnicodeString morpheme() const { return "";};
@@ -136,6 +137,7 @@ public:
   BracketLeaf( CLEX::Type, const icu::UnicodeString&, int,
 	       TiCC::LogStream&, TiCC::UnicodeNormalizer& );
   ~BracketLeaf() override;
+  BracketLeaf *clone() const override;
   icu::UnicodeString put( bool = false ) const override;
   icu::UnicodeString morpheme() const override {
     /// return the value of the morpheme
@@ -180,6 +182,7 @@ class BracketNest: public BaseBracket {
 	       TiCC::LogStream&, TiCC::UnicodeNormalizer& );
   BaseBracket *append( BaseBracket * ) override ;
   ~BracketNest() override;
+  BracketNest *clone() const override;
   bool isNested() const override { return true; };
   icu::UnicodeString put( bool = false ) const override;
   bool testMatch( const std::list<BaseBracket*>& result,
@@ -45,12 +45,46 @@
 #include "frog/clex.h"
 #include "frog/mbma_rule.h"
 #include "frog/mbma_brackets.h"
+#include "frog/result_cache.h"
 
 class MBMAana;
 namespace Timbl{
   class TimblAPI;
 }
 
+/// \brief the private (per thread) state of an Mbma analysis
+///
+/// The Mbma class only holds the shared, read-only model. All intermediate
+/// results live in an MbmaContext, so several threads can analyze words at
+/// the same moment, each using its own context.
+class MbmaContext {
+ public:
+  explicit MbmaContext( const Timbl::TimblAPI * );
+  ~MbmaContext();
+  void clear();
+  Timbl::TimblAPI *tree;       ///< a private child of the shared Timbl tree
+  std::vector<Rule*> analysis; ///< the analyses of the current word
+  /// the classes for every word of the current sentence, as fetched from a
+  /// Timbl server in one request
+  std::map<icu::UnicodeString,std::vector<icu::UnicodeString>> remote_classes;
+  MbmaContext( const MbmaContext& ) = delete;
+  MbmaContext& operator=( const MbmaContext& ) = delete;
+};
+
+/// \brief the final Mbma results for one word, as stored in the cache
+class mbma_result {
+ public:
+  mbma_result() {};
+  ~mbma_result();
+  void store( const frog_record& );
+  void restore( frog_record& ) const;
+  icu::UnicodeString morph_string;
+  std::vector<const BaseBracket*> morph_structure;
+  std::string compound_string;
+  mbma_result( const mbma_result& ) = delete;
+  mbma_result& operator=( const mbma_result& ) = delete;
+};
+
 /// \brief provide all functionality to run a Timbl for Morphological Analyzis
 class Mbma {
  public:
@@ -58,21 +92,37 @@ class Mbma {
   ~Mbma();
   bool init( const TiCC::Configuration& );
   void add_provenance( folia::Document&, folia::processor * ) const;
+  MbmaContext *create_context() const;
   void Classify( frog_record& );
+  void Classify( frog_record&, MbmaContext& ) const;
+  void Classify( frog_data& );
+  void Classify( frog_data&, MbmaContext& ) const;
   void Classify( const icu::UnicodeString&,
 		 const icu::UnicodeString& );
+  void Classify( const icu::UnicodeString&,
+		 const icu::UnicodeString&,
+		 MbmaContext& ) const;
   void filterHeadTag( const icu::UnicodeString& );
+  void filterHeadTag( const icu::UnicodeString&, MbmaContext& ) const;
   void filterSubTags( const std::vector<icu::UnicodeString>& );
+  void filterSubTags( const std::vector<icu::UnicodeString>&,
+		      MbmaContext& ) const;
   void assign_compounds();
+  void assign_compounds( MbmaContext& ) const;
   std::vector<std::pair<icu::UnicodeString,std::string>> getResults( bool=false ) const;
-  void setDeepMorph( bool b ){ doDeepMorph = b; };
+  std::vector<std::pair<icu::UnicodeString,std::string>> getResults( const MbmaContext&,
+								     bool=false ) const;
+  void setDeepMorph( bool );
+  std::string cache_stats() const;
+  bool cache_counts( size_t&, size_t& ) const;
+  void reset_cache_counts();
   void clearAnalysis();
   Rule* matchRule( const std::vector<icu::UnicodeString>&,
 		   const icu::UnicodeString&,
-		   bool );
+		   bool ) const;
   std::vector<Rule*> execute( const icu::UnicodeString&,
 			      const icu::UnicodeString&,
-			      const std::vector<icu::UnicodeString>& );
+			      const std::vector<icu::UnicodeString>& ) const;
   const std::string& version() const { return _version; };
   void add_folia_morphemes( const std::vector<folia::Word*>&,
 			    const frog_data& fd ) const;
@@ -88,12 +138,15 @@ class Mbma {
   bool readsettings( const std::string&, const std::string& );
   void fillMaps();
   void init_cgn( const std::string&, const std::string& );
+  void fill_cache();
   void storeResult( frog_record&,
 		    const icu::UnicodeString&,
-		    const icu::UnicodeString& ) const;
-  std::vector<icu::UnicodeString> make_instances( const icu::UnicodeString& word );
+		    const icu::UnicodeString&,
+		    MbmaContext& ) const;
+  std::vector<icu::UnicodeString> make_instances( const icu::UnicodeString& word ) const;
   void call_server( const std::vector<icu::UnicodeString>&,
-		    std::vector<icu::UnicodeString>& );
+		    std::vector<icu::UnicodeString>& ) const;
+  void prefetch( const frog_data&, MbmaContext& ) const;
   CLEX::Type getFinalTag( const std::list<BaseBracket*>& );
   void store_morphemes( frog_record&,
 			const std::vector<icu::UnicodeString>& ) const;
@@ -109,7 +162,9 @@ class Mbma {
 		       const BracketNest * ) const;
   std::string MTreeFilename;
   Timbl::TimblAPI *MTree;
-  std::vector<Rule*> analysis;
+  MbmaContext *default_context; ///< used by the single threaded interface
+  ResultCache<mbma_result> *cache; ///< the results of frequent words (or 0)
+  std::string cache_file; ///< a file with words to put in the cache at start
   std::string _version;
   std::string textclass;
   TiCC::LogStream *errLog;
@@ -39,6 +39,7 @@
 #include "ticcutils/Unicode.h"
 #include "libfolia/folia.h"
 #include "frog/FrogData.h"
+#include "frog/ner_gazetteer.h"
 
 /// \brief a helper class for Mwu. Stores needed information.
 class mwuAna {
@@ -74,6 +75,7 @@ public:
   ~Mwu();
   void reset();
   bool init( const TiCC::Configuration& );
+  bool compile( const TiCC::Configuration&, const std::string& );
   void add_provenance( folia::Document&, folia::processor * ) const;
   void Classify( frog_data& );
   void add( const frog_record& );
@@ -84,12 +86,14 @@ public:
   const std::string& version() const { return _version; };
 private:
   bool readsettings( const std::string&, const std::string&);
+  bool find_mwu_file( const TiCC::Configuration& );
   bool read_mwus( const std::string& );
   void Classify();
   int debug;
   std::string mwuFileName;
   std::vector<mwuAna*> mWords;
-  mymap2 MWUs;
+  Gazetteer table;   ///< all MWU's from the mwu file
+  mymap2 MWUs;       ///< all sequences of 'glue' words seen so far
   TiCC::LogStream *errLog;
   TiCC::LogStream *dbgLog;
   std::string _version;
@@ -0,0 +1,111 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#ifndef NER_GAZETTEER_H
+#define NER_GAZETTEER_H
+
+#include <cstdint>
+#include <vector>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "unicode/unistr.h"
+
+/// \brief a trie over token sequences, to find all known Named Entities in a
+/// sentence.
+///
+/// Every node of the trie is reached by a sequence of tokens. A node holds a
+/// bitmask of the NE categories (like 'loc' or 'org') of the sequence that
+/// leads to it. Tokens are stored only once, as a number. The edges of all
+/// nodes are stored in one hash table, keyed on (node, token).
+///
+/// A filled Gazetteer can be saved as a binary image, using save(). Such an
+/// image is used with load() without any parsing: it is mmap()-ed read-only,
+/// so all processes using the same image share the same memory pages.
+/// A loaded Gazetteer can not be extended with add().
+///
+/// The Mwu module uses the same structure for its table of Multi Word Units.
+class Gazetteer {
+ public:
+  Gazetteer();
+  ~Gazetteer();
+  Gazetteer( const Gazetteer& ) = delete;
+  Gazetteer& operator=( const Gazetteer& ) = delete;
+  bool add( const std::vector<icu::UnicodeString>&, const std::string& );
+  std::vector<std::set<std::string>> lookup( const std::vector<icu::UnicodeString>& ) const;
+  size_t longest_match( const std::vector<icu::UnicodeString>&, size_t ) const;
+  bool is_prefix( const icu::UnicodeString& ) const;
+  bool save( const std::string& ) const;
+  bool load( const std::string& );
+  static bool is_image( const std::string& );
+  bool is_mapped() const { return _image != 0; };
+  bool empty() const { return _entries == 0; };
+  size_t entries() const { return _entries; };
+  size_t nodes() const { return _nodes; };
+  size_t max_length() const { return _max_length; };
+  size_t memory_usage() const;
+ private:
+  /// \brief hash function for UnicodeString keys
+  struct us_hash {
+    size_t operator()( const icu::UnicodeString& us ) const {
+      return us.hashCode();
+    }
+  };
+  static uint64_t edge_key( uint32_t node, uint32_t token ){
+    return (uint64_t(node) << 32) | token;
+  }
+  int64_t token_id( const icu::UnicodeString& ) const;
+  int64_t child( uint32_t, uint32_t ) const;
+  uint32_t mask( uint32_t node ) const {
+    return _image ? node_masks[node] : masks[node];
+  }
+  void unmap();
+  std::unordered_map<icu::UnicodeString,uint32_t,us_hash> token_ids;
+  std::unordered_map<uint64_t,uint32_t> edges; ///< (node,token) -> node
+  std::vector<uint32_t> masks;        ///< the categories per node
+  std::vector<std::string> categories; ///< the names of the category bits
+  size_t _entries;
+  size_t _nodes;
+  size_t _max_length;
+  // the mmap()-ed image and the tables inside it
+  const char *_image;
+  size_t _image_size;
+  size_t _tokens;
+  const uint32_t *token_index;  ///< start of every token in token_pool
+  const UChar *token_pool;      ///< all tokens, in sorted order
+  const uint32_t *node_edges;   ///< first edge of every node
+  const uint32_t *node_masks;   ///< the categories per node
+  const uint32_t *edge_tokens;  ///< the token per edge, sorted per node
+  const uint32_t *edge_nodes;   ///< the target node per edge
+};
+
+#endif // NER_GAZETTEER_H
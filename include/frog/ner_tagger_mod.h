@@ -38,6 +38,7 @@
 #include "ticcutils/Configuration.h"
 #include "libfolia/folia.h"
 #include "frog/tagger_base.h"
+#include "frog/ner_gazetteer.h"
 
 using tc_pair = std::pair<icu::UnicodeString,double>;
 
@@ -47,7 +48,8 @@ class NERTagger: public BaseTagger {
   explicit NERTagger( TiCC::LogStream *, TiCC::LogStream * =0 );
   bool init( const TiCC::Configuration& ) override;
   void Classify( frog_data& ) override;
-  void post_process( frog_data& ) override;
+  void post_process( frog_data&,
+		     const std::vector<Tagger::TagResult>& ) override;
   void post_process( frog_data&,
 		     const std::vector<tc_pair>& );
   void add_declaration( folia::Document&, folia::processor * ) const override;
@@ -59,12 +61,16 @@ class NERTagger: public BaseTagger {
   bool read_overrides( const std::string& f, const std::string& p ){
     return read_gazets( f, p, override_ners );
   }
-  std::vector<icu::UnicodeString> create_ner_list( const std::vector<icu::UnicodeString>& s ){
+  std::vector<icu::UnicodeString> create_ner_list( const std::vector<icu::UnicodeString>& s ) const {
     return create_ner_list( s, gazet_ners );
   }
-  std::vector<icu::UnicodeString> create_override_list( const std::vector<icu::UnicodeString>& s ){
+  std::vector<icu::UnicodeString> create_override_list( const std::vector<icu::UnicodeString>& s ) const {
     return create_ner_list( s, override_ners );
   }
+  const Gazetteer& gazetteer() const { return gazet_ners; };
+  bool compile_gazets( const TiCC::Configuration&,
+		       const std::string&,
+		       const std::string& );
   bool Generate( const std::string& );
   void merge_override( std::vector<tc_pair>&,
 		       const std::vector<tc_pair>&,
@@ -74,16 +80,16 @@ class NERTagger: public BaseTagger {
  private:
   bool read_gazets( const std::string&,
 		    const std::string&,
-		    std::vector<std::map<icu::UnicodeString,std::set<std::string>>>& );
+		    Gazetteer& );
   bool fill_ners( const std::string&,
 		  const std::string&,
 		  const std::string&,
-		  std::vector<std::map<icu::UnicodeString,std::set<std::string>>>& );
+		  Gazetteer& );
   std::vector<icu::UnicodeString> create_ner_list( const std::vector<icu::UnicodeString>&,
-						   const std::vector<std::map<icu::UnicodeString,std::set<std::string>>>& );
+						   const Gazetteer& ) const;
   std::vector<UnicodeString> serialize( const std::vector<std::set<std::string>>& ) const;
-  std::vector<std::map<icu::UnicodeString,std::set<std::string>>> gazet_ners;
-  std::vector<std::map<icu::UnicodeString,std::set<std::string>>> override_ners;
+  Gazetteer gazet_ners;
+  Gazetteer override_ners;
   void addEntity( frog_data&,
 		  size_t,
 		  const std::vector<tc_pair>& );
@@ -0,0 +1,154 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sstream>
+#include "unicode/unistr.h"
+
+/// \brief a bounded, thread-safe, Least Recently Used cache of results
+///
+/// Natural text follows Zipf's law, so most words are seen over and over.
+/// A ResultCache stores the final results of an expensive classification,
+/// keyed on a UnicodeString. The values are immutable and shared, so a lookup
+/// never copies a result. When the cache is full, the least recently used
+/// entry is dropped.
+template <typename V>
+class ResultCache {
+ public:
+  typedef std::shared_ptr<const V> value_ptr;
+  explicit ResultCache( size_t max ):
+    _capacity( max ),
+    _hits( 0 ),
+    _misses( 0 )
+  {};
+  value_ptr lookup( const icu::UnicodeString& key ){
+    /// find the value for \e key. Returns an empty pointer when not found
+    std::lock_guard<std::mutex> guard( _lock );
+    auto it = _index.find( key );
+    if ( it == _index.end() ){
+      ++_misses;
+      return value_ptr();
+    }
+    ++_hits;
+    // move it to the front, it is the most recently used now
+    _entries.splice( _entries.begin(), _entries, it->second );
+    return it->second->second;
+  }
+  bool contains( const icu::UnicodeString& key ) const {
+    /// check for \e key, without counting it as a hit or a miss
+    std::lock_guard<std::mutex> guard( _lock );
+    return _index.find( key ) != _index.end();
+  }
+  void store( const icu::UnicodeString& key, const value_ptr& value ){
+    /// add a value to the cache. Drops the oldest entry when needed
+    if ( _capacity == 0 ){
+      return;
+    }
+    std::lock_guard<std::mutex> guard( _lock );
+    auto it = _index.find( key );
+    if ( it != _index.end() ){
+      // another thread was faster
+      it->second->second = value;
+      _entries.splice( _entries.begin(), _entries, it->second );
+      return;
+    }
+    _entries.emplace_front( key, value );
+    _index[key] = _entries.begin();
+    if ( _entries.size() > _capacity ){
+      _index.erase( _entries.back().first );
+      _entries.pop_back();
+    }
+  }
+  void clear(){
+    /// remove all entries, but keep the counters
+    std::lock_guard<std::mutex> guard( _lock );
+    _index.clear();
+    _entries.clear();
+  }
+  void reset_counts(){
+    /// set the hit and miss counters to 0, but keep the entries
+    std::lock_guard<std::mutex> guard( _lock );
+    _hits = 0;
+    _misses = 0;
+  }
+  size_t size() const {
+    std::lock_guard<std::mutex> guard( _lock );
+    return _entries.size();
+  }
+  size_t capacity() const { return _capacity; };
+  size_t hits() const {
+    std::lock_guard<std::mutex> guard( _lock );
+    return _hits;
+  }
+  size_t misses() const {
+    std::lock_guard<std::mutex> guard( _lock );
+    return _misses;
+  }
+  std::string stats() const {
+    /// return a human readable summary of the cache usage
+    std::lock_guard<std::mutex> guard( _lock );
+    std::ostringstream os;
+    os << _entries.size() << "/" << _capacity << " entries, "
+       << _hits << " hits, " << _misses << " misses";
+    if ( _hits + _misses > 0 ){
+      os << " (" << (100.0 * _hits) / (_hits + _misses) << "% hits)";
+    }
+    return os.str();
+  }
+  ResultCache( const ResultCache& ) = delete;
+  ResultCache& operator=( const ResultCache& ) = delete;
+ private:
+  /// \brief hash function for UnicodeString keys
+  struct us_hash {
+    size_t operator()( const icu::UnicodeString& us ) const {
+      return us.hashCode();
+    }
+  };
+  typedef std::list<std::pair<icu::UnicodeString,value_ptr>> entry_list;
+  entry_list _entries;  ///< the entries, most recently used first
+  std::unordered_map<icu::UnicodeString,
+		     typename entry_list::iterator,
+		     us_hash> _index;
+  size_t _capacity;
+  size_t _hits;
+  size_t _misses;
+  mutable std::mutex _lock;
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,92 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+#ifndef SENTENCE_PIPELINE_H
+#define SENTENCE_PIPELINE_H
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include "frog/FrogData.h"
+
+/// \brief a bounded queue of sentences, frogged by a fixed number of worker
+/// threads, and delivered back in the original order.
+///
+/// The producer (normally the thread running the tokenizer) submits
+/// sentences together with a 'done' function. The workers run the
+/// 'work' function on the sentences, in any order. The 'done' functions are
+/// ALWAYS run on the producer thread, in submission order. So output and
+/// FoLiA updates need no extra locking.
+class SentencePipeline {
+ public:
+  /// the function a worker runs: (sentence, sentence count, worker number)
+  typedef std::function<void(frog_data&,size_t,size_t)> work_fun;
+  /// the function that consumes a frogged sentence on the producer thread
+  typedef std::function<void(frog_data&)> done_fun;
+  SentencePipeline( size_t, size_t, const work_fun& );
+  ~SentencePipeline();
+  void submit( frog_data&&, size_t, const done_fun& );
+  void flush();
+  size_t workers() const { return threads.size(); };
+  SentencePipeline( const SentencePipeline& ) = delete;
+  SentencePipeline& operator=( const SentencePipeline& ) = delete;
+ private:
+  struct job {
+    job( frog_data&& fd, size_t cnt, const done_fun& f ):
+      sentence( std::move(fd) ),
+      s_count( cnt ),
+      done( f ),
+      ready( false )
+    {};
+    frog_data sentence;
+    size_t s_count;
+    done_fun done;
+    bool ready;
+    std::exception_ptr error;
+  };
+  void work( size_t );
+  bool deliver( std::unique_lock<std::mutex>& );
+  work_fun _work;
+  size_t capacity;
+  bool stopping;
+  std::mutex lock;
+  std::condition_variable todo_cond;  ///< signals new work or a stop
+  std::condition_variable done_cond;  ///< signals a finished sentence
+  std::deque<job*> todo;              ///< jobs waiting for a worker
+  std::deque<job*> pending;           ///< all undelivered jobs, in order
+  std::vector<std::thread> threads;
+};
+
+#endif // SENTENCE_PIPELINE_H
@@ -0,0 +1,83 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#ifndef SERVER_POOL_H
+#define SERVER_POOL_H
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "ticcutils/SocketBasics.h"
+#include "ticcutils/json.hpp"
+
+/// \brief a pool of open connections to one Timbl or MBT server, using one
+/// base.
+///
+/// A connection is set up only once: the greeting of the server is read and
+/// the "base" command is sent. After that, it is reused for every request.
+/// Broken connections are replaced transparently.
+///
+/// There is one pool per host:port:base, shared by all modules and threads.
+/// Use ServerPool::get() to obtain it.
+class ServerPool {
+ public:
+  static std::shared_ptr<ServerPool> get( const std::string&,
+					  const std::string&,
+					  const std::string& );
+  nlohmann::json call( const nlohmann::json& );
+  std::vector<nlohmann::json> pipeline( const std::vector<nlohmann::json>& );
+  std::string name() const { return _host + ":" + _port; };
+  size_t connects() const { return _connects; };
+ private:
+  ServerPool( const std::string&, const std::string&, const std::string& );
+  using connection = std::unique_ptr<Sockets::ClientSocket>;
+  connection connect();
+  connection acquire();
+  void release( connection );
+  bool exchange( Sockets::ClientSocket&,
+		 const std::vector<nlohmann::json>&,
+		 std::vector<nlohmann::json>& );
+  nlohmann::json parse( const std::string& ) const;
+  std::string _host;
+  std::string _port;
+  std::string _base;
+  std::mutex pool_lock;
+  std::vector<connection> idle;  ///< the open connections not in use
+  pid_t owner;                   ///< the process that opened the connections
+  size_t _connects;
+  static const size_t max_idle = 16;
+};
+
+#endif // SERVER_POOL_H
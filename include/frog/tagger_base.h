@@ -33,6 +33,7 @@
 #define TAGGER_BASE_H
 
 #include <vector>
+#include <mutex>
 #include "ticcutils/LogStream.h"
 #include "ticcutils/Configuration.h"
 #include "ticcutils/SocketBasics.h"
@@ -58,7 +59,8 @@ class BaseTagger {
 		       const std::string& );
   virtual ~BaseTagger();
   virtual bool init( const TiCC::Configuration& );
-  virtual void post_process( frog_data& ) = 0;
+  virtual void post_process( frog_data&,
+			     const std::vector<Tagger::TagResult>& ) = 0;
   virtual void Classify( frog_data& );
   virtual void add_declaration( folia::Document&, folia::processor * ) const = 0;
   void add_provenance( folia::Document&, folia::processor * ) const;
@@ -72,9 +74,6 @@ class BaseTagger {
   std::vector<tag_entry> extract_sentence( const frog_data& );
   nlohmann::json create_json( const std::vector<tag_entry>& ) const;
   std::vector<Tagger::TagResult> json_to_TR( const nlohmann::json& in ) const;
-  nlohmann::json read_from_client( Sockets::ClientSocket& ) const;
-  void write_to_client( nlohmann::json&,
-			Sockets::ClientSocket& ) const;
  protected:
   std::vector<Tagger::TagResult> call_server( const std::vector<tag_entry>& ) const;
   int debug;
@@ -88,10 +87,13 @@ class BaseTagger {
   std::string _host;
   std::string _port;
   MbtAPI *tagger;
+  /// MBT is not reentrant, and MbtAPI offers no way to share a loaded
+  /// model between instances. So all workers share this one tagger and the
+  /// calls are serialized: one tagger tags one sentence at a time. Different
+  /// taggers (PoS, IOB, NER) have their own lock and do run concurrently.
+  std::mutex tagger_lock;
   TiCC::UniFilter *filter;
   mutable TiCC::UnicodeNormalizer _normalizer;
-  std::vector<std::string> _words;
-  std::vector<Tagger::TagResult> _tag_result;
   std::map<icu::UnicodeString,icu::UnicodeString> token_tag_map;
   BaseTagger( const BaseTagger& ) = delete; // inhibit copies
   BaseTagger& operator=( const BaseTagger& ) = delete; // inhibit copies
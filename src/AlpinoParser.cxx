@@ -39,7 +39,6 @@
 #include "ticcutils/StringOps.h"
 #include "ticcutils/PrettyPrint.h"
 #include "ticcutils/SocketBasics.h"
-#include "ticcutils/FileUtils.h"
 #include "frog/Frog-util.h"
 #include "frog/FrogData.h"
 
@@ -87,6 +86,9 @@ void AlpinoParser::add_provenance( folia::Document& doc,
   doc.declare( folia::AnnotationType::ENTITY, alpino_mwu_tagset, args );
 }
 
+AlpinoParser::~AlpinoParser(){
+  delete pool;
+}
 
 bool AlpinoParser::init( const TiCC::Configuration& configuration ){
   /// initaliaze an AlpinoParser class from a configuration
@@ -172,8 +174,30 @@ bool AlpinoParser::init( const TiCC::Configuration& configuration ){
     }
   }
   else {
-    string cmd = "which Alpino > /dev/null 2>&1";
-    int res = system( cmd.c_str() );
+    string command = configuration.lookUp( "alpino_command", "parser" );
+    if ( command.empty() ){
+      command = "Alpino -veryfast end_hook=xml_dump -parse -notk";
+    }
+    size_t workers = 1;
+    val = configuration.lookUp( "alpino_workers", "parser" );
+    if ( !val.empty() && !TiCC::stringTo<size_t>( val, workers ) ){
+      LOG << "invalid 'alpino_workers' value in configuration: "
+	  << val << endl;
+      problem = true;
+    }
+    int timeout = 300;
+    val = configuration.lookUp( "alpino_timeout", "parser" );
+    if ( !val.empty() && !TiCC::stringTo<int>( val, timeout ) ){
+      LOG << "invalid 'alpino_timeout' value in configuration: "
+	  << val << endl;
+      problem = true;
+    }
+    vector<string> parts = TiCC::split( command );
+    string cmd;
+    if ( !parts.empty() ){
+      cmd = "which " + parts[0] + " > /dev/null 2>&1";
+    }
+    int res = cmd.empty() ? 1 : system( cmd.c_str() );
     if ( res ){
       string outline = "Cannot find Alpino executable!\n"
 	"possible solution:\n"
@@ -182,8 +206,10 @@ bool AlpinoParser::init( const TiCC::Configuration& configuration ){
       LOG << outline << endl;
       problem = true;
     }
-    else {
-      LOG << "using locally installed Alpino." << endl;
+    else if ( !problem ){
+      pool = new AlpinoPool( command, workers, timeout );
+      LOG << "using locally installed Alpino, with at most "
+	  << pool->max_workers() << " running processes." << endl;
     }
   }
   if ( problem ) {
@@ -799,42 +825,29 @@ vector<parsrel> AlpinoParser::alpino_parse( frog_data& fd ){
     \param fd The frog_data record containing the information to parse
     \return a vector of parsrel structures
 
-    This function uses a local Alpino porgram (which should be configured
-    correctly) by feeding it the sentence contained in \e fd and parses the
-    delivered XML to extract all dependency information
+    This function hands the sentence contained in \e fd to one of the running
+    Alpino processes of our pool and parses the delivered XML to extract all
+    dependency information
   */
 #ifdef DEBUG_ALPINO
   cerr << "calling Alpino input:" << fd.sentence() << endl;
 #endif
   vector<parsrel> result;
+  string xml = pool->parse( fd.sentence() );
+  if ( xml.empty() ){
+    cerr << "Alpino failed on: " << fd.sentence() << endl;
+    return result;
+  }
 #ifdef DEBUG_ALPINO
-  TiCC::tmp_stream temp_stream( "alpino-parse.txt.", true );
-#else
-  TiCC::tmp_stream temp_stream( "alpino-parse.txt." );
-#endif
-  string input_file = temp_stream.tmp_name();
-  string tmp_dir = TiCC::dirname(input_file) +"/";
-  string tmp_str = input_file.substr( input_file.size()-6 );
-  //    Alpino will use the tmp_str part for its output filename.
-  string txt = tmp_str + "|" + fd.sentence();
-  temp_stream.os() << txt;
-  temp_stream.close();
-  string parseCmd = "Alpino -veryfast -flag treebank " + tmp_dir +
-    " end_hook=xml -parse <  " + input_file + " -notk > /dev/null 2>&1";
-#ifdef DEBUG_ALPINO
-  cerr << "run: " << parseCmd << endl;
+  cerr << "received data [" << xml << "]" << endl;
 #endif
-  int res = system( parseCmd.c_str() );
-  if ( res ){
-    cerr << "Alpino failed: RES = " << res << " : " << strerror(res) << endl;
+  xmlDoc *xmldoc = xmlReadMemory( xml.c_str(), xml.length(),
+				  0, 0, XML_PARSE_NOBLANKS );
+  if ( !xmldoc ){
+    cerr << "Alpino returned invalid XML for: " << fd.sentence() << endl;
     return result;
   }
-  string xml_file = tmp_dir + tmp_str + ".xml";
-  xmlDoc *xmldoc = xmlReadFile( xml_file.c_str(), 0, XML_PARSE_NOBLANKS );
   result = extract_dp(xmldoc,fd);
   xmlFreeDoc( xmldoc );
-#ifndef DEBUG_ALPINO
-  TiCC::erase( xml_file );
-#endif
   return result;
 }
@@ -95,7 +95,7 @@ void usage( ) {
        << "\t -n                     Assume input file to hold one sentence per line\n"
        << "\t --retry                assume frog is running again on the same input,\n"
        << "\t                        already done files are skipped. (detected on the basis of already existing output files)\n"
-       << "\t --max-parser-tokens=<n> inhibit parsing when a sentence contains over 'n' tokens. (default: 500, needs already 16Gb of memory!)\n"
+       << "\t --max-parser-tokens=<n> inhibit parsing when a sentence contains over 'n' tokens. (default: 1000, 0 means no limit)\n"
     //       << "\t -Q                     Enable quote detection in tokenizer.\n"
        << "\t --JSONin               The input is JSON. Implies JSONout too! (server mode only)\n"
        << "\t -T or --textredundancy=[full|minimal|none]\n"
@@ -135,6 +135,11 @@ void usage( ) {
        << "\t --alpino               use a locally installed Alpino parser\n"
        << "\t --alpino=server        use a remote installed Alpino server\n"
        << "\t                        (as specified in the frog configuration file)\n"
+       << "\t --lazy-init            Start as soon as the tokenizer and tagger are\n"
+       << "\t                        loaded, and load the other modules meanwhile.\n"
+       << "\t                        (not in server mode)\n"
+       << "\t --compile-mwu=<image>  Compile the MWU file from the configuration into\n"
+       << "\t                        'image', which can replace it. Then stop.\n"
        << "\t ============= OTHER OPTIONS ============================================\n"
        << "\t -h or --help           give some help.\n"
        << "\t -V or --version        Show version info.\n"
@@ -145,10 +150,26 @@ void usage( ) {
     " or the internal Folia (F)\n"
        << "\t                        Multi-Word Units (m), Named Entity Recognition (n), or Parser (p)\n"
        << "\t -S <port>              Run as server instead of reading from testfile, using 'port' \n"
+       << "\t --server-workers=<n>   Handle connections with a pool of 'n' server\n"
+       << "\t                        processes. Default: 0 (a process per connection)\n"
+       << "\t --server-backlog=<n>   Queue at most 'n' waiting connections. Default: 64\n"
+       << "\t --server-max-requests=<n> Restart a server process after 'n' connections.\n"
+       << "\t                        Default: 1000. (0: never)\n"
+       << "\t --server-parallel-min=<n> Use the --workers for requests of at least\n"
+       << "\t                        'n' bytes. Default: 10000\n"
+       << "\t --server-stream        Send the results of every sentence as soon as\n"
+       << "\t                        they are available. (not for FoLiA)\n"
+       << "\t --stats-file=<file>    Write latency and throughput statistics in JSON\n"
+       << "\t                        to 'file' at the end.\n"
 #ifdef HAVE_OPENMP
        << "\t --threads=<n>          Use a maximum of 'n' threads. Default: 8. \n"
 #endif
-       << "\t                         (but always 1 for server mode)\n";
+       << "\t                         (default 1 for server mode)\n"
+       << "\t --workers=<n>          Frog 'n' sentences in parallel, using 'n' worker\n"
+       << "\t                        threads. Default: 1. (in server mode only for\n"
+       << "\t                        large requests, see --server-parallel-min)\n"
+       << "\t --processes=<n>        Frog 'n' input files at the same time, using 'n'\n"
+       << "\t                        processes. Default: 1. (ignored in server mode)\n";
 }
 
 
@@ -202,7 +223,10 @@ int main(int argc, char *argv[]) {
 			  "compounds,language:,retry,nostdout,ner-override:,"
 			  "debug:,keep-parser-files,version,threads:,alpino::,"
 			  "override:,KANON,TESTAPI,debugfile:,JSONin,JSONout::,"
-			  "allow-word-corrections,OLDMWU");
+			  "allow-word-corrections,OLDMWU,workers:,processes:,"
+			  "server-workers:,server-backlog:,server-max-requests:,"
+			  "server-parallel-min:,server-stream,compile-mwu:,"
+			  "lazy-init,stats-file:");
     Opts.init(argc, argv);
     if ( Opts.is_present('V' ) || Opts.is_present("version" ) ){
       // we already did show what we wanted.
@@ -231,7 +255,10 @@ int main(int argc, char *argv[]) {
     theDbgLog->set_message( "frog-" );
     theDbgLog->set_stamp( StampMessage );
     FrogAPI frog( Opts, theErrLog, theDbgLog );
-    if ( !frog.options.fileNames.empty() ) {
+    if ( !frog.options.mwuImage.empty() ){
+      // we only compiled the MWU file
+    }
+    else if ( !frog.options.fileNames.empty() ) {
       frog.run_on_files();
     }
     else if ( frog.options.doServer ) {
@@ -33,6 +33,9 @@
 #include <cstdlib>
 #include <cstdio>
 #include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <poll.h>
 #include <pwd.h>
 #include <signal.h>
 #include <algorithm>
@@ -43,6 +46,10 @@
 #include <sstream>
 #include <fstream>
 #include <vector>
+#include <map>
+#include <memory>
+#include <climits>
+#include <type_traits>
 #include "unicode/schriter.h"
 #include "config.h"
 #ifdef HAVE_OPENMP
@@ -83,6 +90,7 @@
 #include "frog/ner_tagger_mod.h"
 #include "frog/Parser.h"
 #include "frog/AlpinoParser.h"
+#include "frog/sentence_pipeline.h"
 #include "ticcutils/json.hpp"
 
 using namespace std;
@@ -94,6 +102,14 @@ using TiCC::operator<<;
 #define LOG *TiCC::Log(theErrLog)
 #define DBG *TiCC::Log(theDbgLog)
 
+typedef chrono::steady_clock stats_clock;
+
+static uint64_t usecs_since( const stats_clock::time_point& start ){
+  /// return the number of microseconds since \e start
+  return chrono::duration_cast<chrono::microseconds>( stats_clock::now()
+						       - start ).count();
+}
+
 /// the FoLiA setname for languages
 const string ISO_SET = "http://raw.github.com/proycon/folia/master/setdefinitions/iso639_3.foliaset";
 
@@ -163,26 +179,34 @@ FrogOptions::FrogOptions():
   doJSONin(false),
   doJSONout(false),
   doServer(false),
+  serverStream(false),
   doKanon(false),
   test_API(false),
   hide_timers(false),
   interactive(false),
+  lazyInit(false),
   doAlpinoServer(false),
   doAlpino(false),
   do_und_language(false),
   do_language_detection(false),
   numThreads(1),
+  numWorkers(1),
+  numProcesses(1),
   debugFlag(0),
   JSON_pp(0),
   uttmark("<utt>"),
   listenport("void"),
+  serverWorkers(0),
+  serverBacklog(64),
+  serverMaxRequests(1000),
+  serverParallelMin(10000),
   docid("untitled"),
   inputclass("current"),
   outputclass("current"),
   textredundancy("minimal"),
   debug_folia( "NODEBUG" ),
   correct_words(false),
-  maxParserTokens(500) // 500 words in a sentence is already insane
+  maxParserTokens(1000) // 1000 words in a sentence is already insane
   // needs about 16 Gb memory to parse!
   // set tot 0 for unlimited
 {
@@ -546,18 +570,32 @@ bool FrogAPI::collect_options( TiCC::CL_Options& Opts,
     configuration.setatt( "ner_override", opt_val, "NER" );
   }
   options.doServer = Opts.extract('S', options.listenport );
+  struct { const char *name; int *value; int min; } server_opts[] = {
+    { "server-workers", &options.serverWorkers, 0 },
+    { "server-backlog", &options.serverBacklog, 1 },
+    { "server-max-requests", &options.serverMaxRequests, 0 },
+    { "server-parallel-min", &options.serverParallelMin, 0 } };
+  for ( const auto& so : server_opts ){
+    if ( Opts.extract( so.name, opt_val ) ){
+      int num;
+      if ( !TiCC::stringTo<int>( opt_val, num ) || num < so.min ){
+	LOG << so.name << " value should be an integer >= " << so.min << endl;
+	return false;
+      }
+      if ( !options.doServer ){
+	LOG << "--" << so.name << " is only used in server mode. (ignored)"
+	    << endl;
+      }
+      *so.value = num;
+    }
+  }
   options.doJSONin = Opts.extract( "JSONin" );
   if ( options.doJSONin && !options.doServer ){
     LOG << "option JSONin is only allowed for server mode. (-S option)" << endl;
     return false;
   }
 #ifdef HAVE_OPENMP
-  if ( options.doServer ) {
-    // run in one thread in server mode, forking is too expensive for lots of small snippets
-    options.numThreads =  1;
-    Opts.extract( "threads", opt_val ); //discard threads option
-  }
-  else if ( Opts.extract( "threads", opt_val ) ){
+  if ( Opts.extract( "threads", opt_val ) ){
     int num;
     if ( !TiCC::stringTo<int>( opt_val, num ) || num < 1 ){
       LOG << "threads value should be a positive integer" << endl;
@@ -565,6 +603,11 @@ bool FrogAPI::collect_options( TiCC::CL_Options& Opts,
     }
     options.numThreads = num;
   }
+  else if ( options.doServer ) {
+    // by default run in one thread per connection in server mode,
+    // starting threads is too expensive for lots of small snippets
+    options.numThreads =  1;
+  }
 #else
   if ( Opts.extract( "threads", opt_val ) ){
     LOG << "WARNING!\n---> There is NO OpenMP support enabled\n"
@@ -572,6 +615,47 @@ bool FrogAPI::collect_options( TiCC::CL_Options& Opts,
 		    << "---> Will continue on just 1 thread." << endl;
   }
 #endif
+  // the Parser's OpenMP team for long sentences. Its workers may run in
+  // their own std::threads, which don't see omp_set_num_threads()
+  configuration.setatt( "threads",
+			TiCC::toString( options.numThreads ),
+			"parser" );
+  if ( Opts.extract( "workers", opt_val ) ){
+    int num;
+    if ( !TiCC::stringTo<int>( opt_val, num ) || num < 1 ){
+      LOG << "workers value should be a positive integer" << endl;
+      return false;
+    }
+    options.numWorkers = num;
+  }
+  Opts.extract( "compile-mwu", options.mwuImage );
+  Opts.extract( "stats-file", options.statsFile );
+  if ( Opts.extract( "lazy-init" ) ){
+    if ( options.doServer ){
+      LOG << "--lazy-init is not supported in server mode. (ignored)" << endl;
+    }
+    else {
+      options.lazyInit = true;
+    }
+  }
+  if ( Opts.extract( "processes", opt_val ) ){
+    int num;
+    if ( !TiCC::stringTo<int>( opt_val, num ) || num < 1 ){
+      LOG << "processes value should be a positive integer" << endl;
+      return false;
+    }
+    if ( options.doServer ){
+      LOG << "--processes is not supported in server mode. (ignored)" << endl;
+    }
+    else {
+      options.numProcesses = num;
+    }
+  }
+  if ( options.lazyInit && options.numProcesses > 1 ){
+    // the loader threads would not survive the fork of the worker processes
+    LOG << "--lazy-init is not supported with --processes. (ignored)" << endl;
+    options.lazyInit = false;
+  }
 
   if ( Opts.extract( "keep-parser-files" ) ){
     LOG << "keep-parser-files option not longer supported. (ignored)" << endl;
@@ -685,6 +769,17 @@ bool FrogAPI::collect_options( TiCC::CL_Options& Opts,
       }
     }
   }
+  if ( Opts.extract( "server-stream" ) ){
+    if ( !options.doServer ){
+      LOG << "--server-stream is only used in server mode. (ignored)" << endl;
+    }
+    else if ( options.doXMLin || options.doXMLout ){
+      LOG << "--server-stream is not possible for FoLiA. (ignored)" << endl;
+    }
+    else {
+      options.serverStream = true;
+    }
+  }
   string textclass;
   string inputclass;
   string outputclass;
@@ -867,7 +962,10 @@ FrogAPI::FrogAPI( TiCC::CL_Options& Opts,
   myCGNTagger(0),
   myIOBTagger(0),
   myNERTagger(0),
-  tokenizer(0)
+  tokenizer(0),
+  stats(0),
+  pipeline(0),
+  serial_only(false)
 {
   /// Initialize an FrogAPI class
   /*!
@@ -887,11 +985,21 @@ FrogAPI::FrogAPI( TiCC::CL_Options& Opts,
   if (!parsed) {
     throw runtime_error( "init failed" );
   }
+  if ( !options.mwuImage.empty() ){
+    // only compile the MWU file, no need to initialize Frog
+    Mwu mwu( theErrLog, theDbgLog );
+    if ( !mwu.compile( configuration, options.mwuImage ) ){
+      throw runtime_error( "compiling the mwu file failed" );
+    }
+    return;
+  }
   run_api( configuration );
 }
 
 void FrogAPI::run_api( const TiCC::Configuration& configuration ){
-  if ( options.doServer ){
+  // create the statistics first, so fork()ed processes share them
+  stats = FrogStats::create();
+  if ( options.doServer || options.numProcesses > 1 ){
     // we use fork(). omp (GCC version) doesn't do well when omp is used
     // before the fork!
     // see: http://bisqwit.iki.fi/story/howto/openmp/#OpenmpAndFork
@@ -976,195 +1084,384 @@ void FrogAPI::run_api( const TiCC::Configuration& configuration ){
 
 #endif
 
-    bool tokStat = true;
-    string tokWhat;
-    bool lemStat = true;
-    string lemWhat;
-    bool mwuStat = true;
-    string mwuWhat;
-    bool mbaStat = true;
-    string mbaWhat;
-    bool parStat = true;
-    string parWhat;
-    bool tagStat = true;
-    string tagWhat;
-    bool iobStat = true;
-    string iobWhat;
-    bool nerStat = true;
-    string nerWhat;
+    if ( options.lazyInit ){
+      start_lazy_init( configuration );
+    }
+    else {
+      bool tokStat = true;
+      string tokWhat;
+      bool lemStat = true;
+      string lemWhat;
+      bool mbaStat = true;
+      string mbaWhat;
+      bool mwuStat = true;
+      string mwuWhat;
+      bool parStat = true;
+      string parWhat;
+      bool tagStat = true;
+      string tagWhat;
+      bool iobStat = true;
+      string iobWhat;
+      bool nerStat = true;
+      string nerWhat;
 
 #pragma omp parallel sections
-    {
-#pragma omp section
       {
-	try {
-	  tokenizer = new UctoTokenizer(theErrLog,theDbgLog);
-	  tokStat = tokenizer->init( configuration );
-	}
-	catch ( const exception& e ){
-	  tokWhat = e.what();
-	  tokStat = false;
-	}
-	if ( tokStat ){
-	  tokenizer->setPassThru( !options.doTok );
-	  tokenizer->setDocID( options.docid );
-	  tokenizer->setSentencePerLineInput( options.doSentencePerLine );
-	  tokenizer->setQuoteDetection( options.doQuoteDetection );
-	  tokenizer->setInputEncoding( options.encoding );
-	  tokenizer->setInputXml( options.doXMLin );
-	  tokenizer->setUttMarker( options.uttmark );
-	  tokenizer->setInputClass( options.inputclass );
-	  tokenizer->setOutputClass( options.outputclass );
-	  tokenizer->setWordCorrection( options.correct_words );
-	  tokenizer->setUndLang( options.do_und_language );
-	  tokenizer->setLangDetection( options.do_language_detection );
-	}
-      }
 #pragma omp section
-      {
-	if ( options.doLemma ){
+	{
 	  try {
-	    myMblem = new Mblem(theErrLog,theDbgLog);
-	    lemStat = myMblem->init( configuration );
+	    tokStat = init_tokenizer( configuration );
 	  }
 	  catch ( const exception& e ){
-	    lemWhat = e.what();
-	    lemStat = false;
+	    tokWhat = e.what();
+	    tokStat = false;
 	  }
 	}
-      }
 #pragma omp section
-      {
-	if ( options.doMbma ){
-	  try {
-	    myMbma = new Mbma(theErrLog,theDbgLog);
-	    mbaStat = myMbma->init( configuration );
-	    if ( options.doDeepMorph ){
-	      myMbma->setDeepMorph(true);
+	{
+	  if ( options.doLemma ){
+	    try {
+	      lemStat = init_lemmatizer( configuration );
+	    }
+	    catch ( const exception& e ){
+	      lemWhat = e.what();
+	      lemStat = false;
 	    }
-	  }
-	  catch ( const exception& e ){
-	    mbaWhat = e.what();
-	    mbaStat = false;
 	  }
 	}
-      }
 #pragma omp section
-      {
-	try {
-	  myCGNTagger = new CGNTagger( theErrLog, theDbgLog );
-	  tagStat = myCGNTagger->init( configuration );
-	}
-	catch ( const exception& e ){
-	  tagWhat = e.what();
-	  tagStat = false;
+	{
+	  if ( options.doMbma ){
+	    try {
+	      mbaStat = init_mbma( configuration );
+	    }
+	    catch ( const exception& e ){
+	      mbaWhat = e.what();
+	      mbaStat = false;
+	    }
+	  }
 	}
-      }
 #pragma omp section
-      {
-	if ( options.doIOB ){
+	{
 	  try {
-	    myIOBTagger = new IOBTagger( theErrLog, theDbgLog );
-	    iobStat = myIOBTagger->init( configuration );
+	    tagStat = init_tagger( configuration );
 	  }
 	  catch ( const exception& e ){
-	    iobWhat = e.what();
-	    iobStat = false;
+	    tagWhat = e.what();
+	    tagStat = false;
 	  }
 	}
-      }
 #pragma omp section
-      {
-	if ( options.doNER ){
-	  try {
-	    myNERTagger = new NERTagger( theErrLog, theDbgLog );
-	    nerStat = myNERTagger->init( configuration );
-	  }
-	  catch ( const exception& e ){
-	    nerWhat = e.what();
-	    nerStat = false;
+	{
+	  if ( options.doIOB ){
+	    try {
+	      iobStat = init_iob( configuration );
+	    }
+	    catch ( const exception& e ){
+	      iobWhat = e.what();
+	      iobStat = false;
+	    }
 	  }
 	}
-      }
 #pragma omp section
-      {
-	if ( options.doAlpino ){
-	  TiCC::Timer initTimer;
-	  initTimer.start();
-	  try {
-	    myParser = new AlpinoParser( theErrLog, theDbgLog );
-	    parStat = myParser->init( configuration );
-	    initTimer.stop();
-	    LOG << "init Parse took: " << initTimer << endl;
-	  }
-	  catch ( const exception& e ){
-	    parWhat = e.what();
-	    parStat = false;
+	{
+	  if ( options.doNER ){
+	    try {
+	      nerStat = init_ner( configuration );
+	    }
+	    catch ( const exception& e ){
+	      nerWhat = e.what();
+	      nerStat = false;
+	    }
 	  }
 	}
-	else if ( options.doMwu ){
-	  try {
-	    myMwu = new Mwu( theErrLog, theDbgLog );
-	    mwuStat = myMwu->init( configuration );
-	    if ( mwuStat && options.doParse ){
-	      TiCC::Timer initTimer;
-	      initTimer.start();
-	      try {
-		myParser = new Parser( theErrLog, theDbgLog );
-		parStat = myParser->init( configuration );
-		initTimer.stop();
-		LOG << "init Parse took: " << initTimer << endl;
-	      }
-	      catch ( const exception& e ){
-		parWhat = e.what();
-		parStat = false;
-	      }
+#pragma omp section
+	{
+	  if ( !options.doAlpino && options.doMwu ){
+	    try {
+	      mwuStat = init_mwu( configuration );
+	    }
+	    catch ( const exception& e ){
+	      mwuWhat = e.what();
+	      mwuStat = false;
 	    }
 	  }
-	  catch ( const exception& e ){
-	    mwuWhat = e.what();
-	    mwuStat = false;
+	  if ( options.doAlpino
+	       || ( options.doMwu && mwuStat && options.doParse ) ){
+	    try {
+	      parStat = init_parser( configuration );
+	    }
+	    catch ( const exception& e ){
+	      parWhat = e.what();
+	      parStat = false;
+	    }
 	  }
 	}
+      }   // end omp parallel sections
+      if ( ! ( tokStat && iobStat && nerStat && tagStat && lemStat
+	       && mbaStat && mwuStat && parStat ) ){
+	string out = "Initialization failed for: ";
+	if ( !tokStat ){
+	  out += "[tokenizer] " + tokWhat;
+	}
+	if ( !tagStat ){
+	  out += "[tagger] " + tagWhat;
+	}
+	if ( !iobStat ){
+	  out += "[IOB] " + iobWhat;
+	}
+	if ( !nerStat ){
+	  out += "[NER] " + nerWhat;
+	}
+	if ( !lemStat ){
+	  out += "[lemmatizer] " + lemWhat;
+	}
+	if ( !mbaStat ){
+	  out += "[morphology] " + mbaWhat;
+	}
+	if ( !mwuStat ){
+	  out += "[multiword unit] " + mwuWhat;
+	}
+	if ( !parStat ){
+	  out += "[parser] " + parWhat;
+	}
+	LOG << out << endl;
+	throw runtime_error( "Frog init failed" );
       }
-    }   // end omp parallel sections
-    if ( ! ( tokStat && iobStat && nerStat && tagStat && lemStat
-	     && mbaStat && mwuStat && parStat ) ){
-      string out = "Initialization failed for: ";
-      if ( !tokStat ){
-	out += "[tokenizer] " + tokWhat;
-      }
-      if ( !tagStat ){
-	out += "[tagger] " + tagWhat;
-      }
-      if ( !iobStat ){
-	out += "[IOB] " + iobWhat;
-      }
-      if ( !nerStat ){
-	out += "[NER] " + nerWhat;
-      }
-      if ( !lemStat ){
-	out += "[lemmatizer] " + lemWhat;
-      }
-      if ( !mbaStat ){
-	out += "[morphology] " + mbaWhat;
-      }
-      if ( !mwuStat ){
-	out += "[multiword unit] " + mwuWhat;
-      }
-      if ( !parStat ){
-	out += "[parser] " + parWhat;
-      }
-      LOG << out << endl;
-      throw runtime_error( "Frog init failed" );
     }
   }
-  LOG << TiCC::Timer::now() <<  " Initialization done." << endl;
+  int num_contexts = max( 1, options.numWorkers );
+  for ( int i=0; i < num_contexts; ++i ){
+    if ( options.lazyInit ){
+      // Mbma and Mblem may still be loading. Their part of the context is
+      // created when they are first needed, see frog_one_sentence()
+      contexts.push_back( new worker_context( 0, 0 ) );
+    }
+    else {
+      contexts.push_back( new worker_context( myMbma, myMblem ) );
+    }
+  }
+  if ( options.lazyInit ){
+    LOG << TiCC::Timer::now() <<  " Initialization done. (other modules are "
+	<< "still loading)" << endl;
+  }
+  else {
+    LOG << TiCC::Timer::now() <<  " Initialization done." << endl;
+  }
+}
+
+bool FrogAPI::init_tokenizer( const TiCC::Configuration& configuration ){
+  /// create and initialize the tokenizer
+  tokenizer = new UctoTokenizer(theErrLog,theDbgLog);
+  bool stat = tokenizer->init( configuration );
+  if ( stat ){
+    tokenizer->setPassThru( !options.doTok );
+    tokenizer->setDocID( options.docid );
+    tokenizer->setSentencePerLineInput( options.doSentencePerLine );
+    tokenizer->setQuoteDetection( options.doQuoteDetection );
+    tokenizer->setInputEncoding( options.encoding );
+    tokenizer->setInputXml( options.doXMLin );
+    tokenizer->setUttMarker( options.uttmark );
+    tokenizer->setInputClass( options.inputclass );
+    tokenizer->setOutputClass( options.outputclass );
+    tokenizer->setWordCorrection( options.correct_words );
+    tokenizer->setUndLang( options.do_und_language );
+    tokenizer->setLangDetection( options.do_language_detection );
+  }
+  return stat;
+}
+
+bool FrogAPI::init_tagger( const TiCC::Configuration& configuration ){
+  /// create and initialize the CGN tagger
+  myCGNTagger = new CGNTagger( theErrLog, theDbgLog );
+  return myCGNTagger->init( configuration );
+}
+
+bool FrogAPI::init_lemmatizer( const TiCC::Configuration& configuration ){
+  /// create and initialize the lemmatizer
+  myMblem = new Mblem( theErrLog, theDbgLog );
+  return myMblem->init( configuration );
 }
 
+bool FrogAPI::init_mbma( const TiCC::Configuration& configuration ){
+  /// create and initialize the morphological analyzer
+  myMbma = new Mbma( theErrLog, theDbgLog );
+  bool stat = myMbma->init( configuration );
+  if ( options.doDeepMorph ){
+    myMbma->setDeepMorph(true);
+  }
+  return stat;
+}
+
+bool FrogAPI::init_iob( const TiCC::Configuration& configuration ){
+  /// create and initialize the IOB chunker
+  myIOBTagger = new IOBTagger( theErrLog, theDbgLog );
+  return myIOBTagger->init( configuration );
+}
+
+bool FrogAPI::init_ner( const TiCC::Configuration& configuration ){
+  /// create and initialize the NER
+  myNERTagger = new NERTagger( theErrLog, theDbgLog );
+  return myNERTagger->init( configuration );
+}
+
+bool FrogAPI::init_mwu( const TiCC::Configuration& configuration ){
+  /// create and initialize the MWU module
+  myMwu = new Mwu( theErrLog, theDbgLog );
+  return myMwu->init( configuration );
+}
+
+bool FrogAPI::init_parser( const TiCC::Configuration& configuration ){
+  /// create and initialize the parser. Alpino or our own
+  TiCC::Timer initTimer;
+  initTimer.start();
+  if ( options.doAlpino ){
+    myParser = new AlpinoParser( theErrLog, theDbgLog );
+  }
+  else {
+    myParser = new Parser( theErrLog, theDbgLog );
+  }
+  bool stat = myParser->init( configuration );
+  initTimer.stop();
+  LOG << "init Parse took: " << initTimer << endl;
+  return stat;
+}
+
+void FrogAPI::start_lazy_init( const TiCC::Configuration& configuration ){
+  /// initialize the tokenizer and the tagger, and load all other modules in
+  /// the background
+  /*!
+    \param configuration the configuration to use
+
+    Every module gets its own loader thread. We only wait for the tokenizer
+    and the tagger, which are needed for every sentence. Frogging a sentence
+    waits for the other modules it needs, see wait_for(). A module that
+    fails to initialize throws when it is first needed.
+  */
+  auto conf = make_shared<TiCC::Configuration>( configuration );
+  auto load = [this,conf]( bool (FrogAPI::*init)( const TiCC::Configuration& ),
+			   const string& name ){
+    return async( launch::async,
+		  [this,conf,init,name]{
+		    TiCC::Timer initTimer;
+		    initTimer.start();
+		    bool stat = false;
+		    try {
+		      stat = (this->*init)( *conf );
+		    }
+		    catch ( const exception& e ){
+		      throw runtime_error( "Initialization failed for: ["
+					   + name + "] " + e.what() );
+		    }
+		    if ( !stat ){
+		      throw runtime_error( "Initialization failed for: ["
+					   + name + "]" );
+		    }
+		    initTimer.stop();
+		    LOG << "loading " << name << " took: " << initTimer << endl;
+		  } ).share();
+  };
+  shared_future<void> tok_loader = load( &FrogAPI::init_tokenizer,
+					 "tokenizer" );
+  shared_future<void> tag_loader = load( &FrogAPI::init_tagger, "tagger" );
+  if ( options.doLemma ){
+    mblem_loader = load( &FrogAPI::init_lemmatizer, "lemmatizer" );
+  }
+  if ( options.doMbma ){
+    mbma_loader = load( &FrogAPI::init_mbma, "morphology" );
+  }
+  if ( options.doIOB ){
+    iob_loader = load( &FrogAPI::init_iob, "IOB" );
+  }
+  if ( options.doNER ){
+    ner_loader = load( &FrogAPI::init_ner, "NER" );
+  }
+  if ( options.doAlpino ){
+    parser_loader = load( &FrogAPI::init_parser, "parser" );
+  }
+  else if ( options.doMwu ){
+    mwu_loader = load( &FrogAPI::init_mwu, "multiword unit" );
+    if ( options.doParse ){
+      parser_loader = load( &FrogAPI::init_parser, "parser" );
+    }
+  }
+  try {
+    tok_loader.get();
+    tag_loader.get();
+  }
+  catch ( const exception& e ){
+    LOG << e.what() << endl;
+    tok_loader.wait();
+    tag_loader.wait();
+    join_loaders();
+    throw runtime_error( "Frog init failed" );
+  }
+}
+
+void FrogAPI::wait_for( const shared_future<void>& loader ) const {
+  /// wait until a module, loading in the background, is ready
+  /*!
+    \param loader the loader of the module. When it is not valid (without
+    lazy init) we return immediately.
+
+    This throws when the module failed to initialize.
+  */
+  if ( loader.valid() ){
+    loader.get();
+  }
+}
+
+void FrogAPI::wait_for_modules() const {
+  /// wait until all modules are loaded
+  wait_for( mblem_loader );
+  wait_for( mbma_loader );
+  wait_for( iob_loader );
+  wait_for( ner_loader );
+  wait_for( mwu_loader );
+  wait_for( parser_loader );
+}
+
+void FrogAPI::join_loaders(){
+  /// wait until all background loaders are finished, ignoring failures
+  for ( const auto *loader : { &mblem_loader, &mbma_loader, &iob_loader,
+			       &ner_loader, &mwu_loader, &parser_loader } ){
+    if ( loader->valid() ){
+      loader->wait();
+    }
+  }
+}
+
+
+worker_context::worker_context( const Mbma *mbma_mod,
+				const Mblem *mblem_mod ):
+  mbma(0),
+  mblem(0)
+{
+  /// create the private state for one worker
+  /*!
+    \param mbma_mod the (shared) Mbma module. May be 0
+    \param mblem_mod the (shared) Mblem module. May be 0
+  */
+  if ( mbma_mod ){
+    mbma = mbma_mod->create_context();
+  }
+  if ( mblem_mod ){
+    mblem = mblem_mod->create_context();
+  }
+}
+
+worker_context::~worker_context(){
+  delete mbma;
+  delete mblem;
+}
 
 FrogAPI::~FrogAPI() {
   /// Destructor. Clears all resources
+  delete pipeline;
+  join_loaders();
+  for ( const auto *ctx : contexts ){
+    delete ctx;
+  }
   delete myMbma;
   delete myMblem;
   delete myMwu;
@@ -1172,119 +1469,313 @@ FrogAPI::~FrogAPI() {
   delete myIOBTagger;
   delete myNERTagger;
   delete myParser;
+  FrogStats::destroy( stats );
   delete tokenizer;
 }
 
-void FrogAPI::run_on_files(){
-  string outPath = options.outputDirName;
-  string xmlPath = options.xmlDirName;
-
-  if ( options.fileNames.size() > 1 ){
-    LOG << "start processing " << options.fileNames.size() << " files..." << endl;
+bool FrogAPI::prepare_file_job( const string& name, file_job& job ) const {
+  /// determine the input and output files for one input file
+  /*!
+    \param name the name of the input file, as given by the user
+    \param job the resulting file names
+    \return false when the file should be skipped
+  */
+  job.name = name;
+  job.testName = options.testDirName + name;
+  if ( !TiCC::isFile( job.testName ) ){
+    LOG << "skip " << job.testName << " (file not found )"
+	<< endl;
+    return false;
   }
-  for ( auto const& name : options.fileNames ){
-    string testName = options.testDirName + name;
-    if ( !TiCC::isFile( testName ) ){
-      LOG << "skip " << testName << " (file not found )"
+  if ( outS == 0 && options.wantOUT ){
+    if ( options.doXMLin ){
+      if ( !options.outputDirName.empty() ){
+	job.outName = options.outputDirName + name + ".out";
+      }
+    }
+    else {
+      job.outName = options.outputDirName + name + ".out";
+    }
+    if ( options.doRetry && TiCC::isFile( job.outName ) ){
+      LOG << "retry, skip: " << job.outName << " already exists" << endl;
+      return false;
+    }
+    if ( !TiCC::createPath( job.outName ) ) {
+      LOG << "problem frogging: " << name << endl
+	  << "unable to create outputfile: " << job.outName
 	  << endl;
-      continue;
+      return false;
     }
-    string outName;
-    if ( outS == 0 ){
-      if ( options.wantOUT ){
-	if ( options.doXMLin ){
-	  if ( !outPath.empty() ){
-	    outName = outPath + name + ".out";
-	  }
-	}
-	else {
-	  outName = outPath + name + ".out";
-	}
-	if ( options.doRetry && TiCC::isFile( outName ) ){
-	  LOG << "retry, skip: " << outName << " already exists" << endl;
-	  continue;
-	}
-	if ( !TiCC::createPath( outName ) ) {
-	  LOG << "problem frogging: " << name << endl
-	      << "unable to create outputfile: " << outName
-	      << endl;
-	  continue;
-	}
-	outS = new ofstream( outName );
+  }
+  job.xmlOutName = options.XMLoutFileName;
+  if ( job.xmlOutName.empty() ){
+    if ( !options.xmlDirName.empty() ){
+      if ( name.rfind(".xml") == string::npos ){
+	job.xmlOutName = options.xmlDirName + name + ".xml";
       }
       else {
-	outS = &cout;
+	job.xmlOutName = options.xmlDirName + name;
       }
     }
-    string xmlOutName = options.XMLoutFileName;
-    if ( xmlOutName.empty() ){
-      if ( !options.xmlDirName.empty() ){
-	if ( name.rfind(".xml") == string::npos ){
-	  xmlOutName = xmlPath + name + ".xml";
-	}
-	else {
-	  xmlOutName = xmlPath + name;
-	}
-      }
-      else if ( options.doXMLout ){
-	xmlOutName = name + ".xml"; // do not clobber the inputdir!
-      }
+    else if ( options.doXMLout ){
+      job.xmlOutName = name + ".xml"; // do not clobber the inputdir!
     }
-    if ( !xmlOutName.empty() ){
-      if ( options.doRetry && TiCC::isFile( xmlOutName ) ){
-	LOG << "retry, skip: " << xmlOutName << " already exists" << endl;
-	continue;
+  }
+  if ( !job.xmlOutName.empty() ){
+    if ( options.doRetry && TiCC::isFile( job.xmlOutName ) ){
+      LOG << "retry, skip: " << job.xmlOutName << " already exists" << endl;
+      return false;
+    }
+    if ( !TiCC::createPath( job.xmlOutName ) ){
+      LOG << "problem frogging: " << name << endl
+	  << "unable to create outputfile: " << job.xmlOutName
+	  << endl;
+      return false;
+    }
+    else {
+      remove( job.xmlOutName.c_str() );
+    }
+  }
+  return true;
+}
+
+bool FrogAPI::frog_file_job( const file_job& job ){
+  /// frog one input file and store the results
+  /*!
+    \param job the input and output file names
+    \return false when frogging failed
+  */
+  if ( outS == 0 ){
+    if ( options.wantOUT ){
+      outS = new ofstream( job.outName );
+    }
+    else {
+      outS = &cout;
+    }
+  }
+  LOG << TiCC::Timer::now() << " Frogging " << job.testName << endl;
+  if ( options.test_API ){
+    run_api_tests( job.testName );
+    return true;
+  }
+  folia::Document *result = 0;
+  try {
+    result = FrogFile( job.testName );
+  }
+  catch ( exception& e ){
+    LOG << "problem frogging: " << job.name << endl
+	<< e.what() << endl;
+    return false;
+  }
+  bool ok = true;
+  if ( !job.xmlOutName.empty() ){
+    if ( !result ){
+      LOG << "FAILED to create FoLiA: " << job.xmlOutName << endl;
+      ok = false;
+    }
+    else {
+      result->save( job.xmlOutName, options.doKanon );
+      LOG << "FoLiA stored in " << job.xmlOutName << endl;
+      delete result;
+    }
+  }
+  if ( !job.outName.empty() ){
+    LOG << "results stored in " << job.outName << endl;
+    if ( outS != &cout ){
+      delete outS;
+      outS = 0;
+    }
+  }
+  if ( !options.outputFileName.empty() ){
+    LOG << "results stored in " << options.outputFileName << endl;
+    if ( outS != &cout ){
+      delete outS;
+      outS = 0;
+    }
+  }
+  return ok;
+}
+
+/// \brief what a child of run_files_parallel() sends back to its parent
+struct child_result {
+  uint32_t done = 0;    ///< the number of files frogged
+  uint32_t failed = 0;  ///< the number of files that failed
+  TimerBlock timers;    ///< the summed timers of all those files
+};
+// it is sent as raw bytes between processes running the same binary
+static_assert( std::is_trivially_copyable<TimerBlock>::value,
+	       "a TimerBlock can't be sent over a pipe" );
+static_assert( sizeof(child_result) <= PIPE_BUF,
+	       "a child_result must be written atomically" );
+
+void FrogAPI::run_files_parallel( const vector<file_job>& jobs ){
+  /// frog a list of files, using several processes
+  /*!
+    \param jobs the files to frog
+
+    We fork() options.numProcesses children, which share the models we
+    loaded. The children take the index of the next file to frog from a
+    pipe, until all files are done. Every file is handled by one child, so
+    the output per file is the same as when running sequentially.
+    At the end, every child sends the number of files it frogged, the
+    number of failures and its summed timers back over a second pipe.
+  */
+  int job_pipe[2];
+  int result_pipe[2];
+  if ( pipe( job_pipe ) != 0 || pipe( result_pipe ) != 0 ){
+    throw runtime_error( string("pipe() failed: ") + strerror(errno) );
+  }
+  size_t num_procs = min( jobs.size(), size_t(options.numProcesses) );
+  LOG << "frogging " << jobs.size() << " files using " << num_procs
+      << " processes" << endl;
+  TiCC::Timer wallTimer;
+  wallTimer.start();
+  vector<pid_t> children;
+  for ( size_t p=0; p < num_procs; ++p ){
+    cout.flush();
+    pid_t pid = fork();
+    if ( pid < 0 ){
+      string err = strerror(errno);
+      LOG << "ERROR on fork: " << err << endl;
+      if ( children.empty() ){
+	throw runtime_error( "FORK failed: " + err );
       }
-      if ( !TiCC::createPath( xmlOutName ) ){
-	LOG << "problem frogging: " << name << endl
-	    << "unable to create outputfile: " << xmlOutName
-	    << endl;
-	continue;
+      break; // go on with the children we have
+    }
+    if ( pid == 0 ){
+      close( job_pipe[1] );
+      close( result_pipe[0] );
+      child_result res;
+      uint32_t index;
+      while ( read( job_pipe[0], &index, sizeof(index) ) == sizeof(index) ){
+	++res.done;
+	if ( !frog_file_job( jobs[index] ) ){
+	  ++res.failed;
+	}
+	res.timers.add( timers ); // FrogFile() collected those for this file
       }
-      else {
-	remove( xmlOutName.c_str() );
+      cout.flush();
+      if ( write( result_pipe[1], &res, sizeof(res) ) != sizeof(res) ){
+	exit( EXIT_FAILURE );
       }
-    }
-    LOG << TiCC::Timer::now() << " Frogging " << testName << endl;
-    if ( options.test_API ){
-      run_api_tests( testName );
+      exit( EXIT_SUCCESS );
+    }
+    children.push_back( pid );
+  }
+  close( job_pipe[0] );
+  close( result_pipe[1] );
+  // when all children died, writing to the job pipe fails with EPIPE.
+  // Don't let SIGPIPE kill us before we can report that
+  struct sigaction ignore_pipe;
+  struct sigaction old_pipe;
+  memset( &ignore_pipe, 0, sizeof(ignore_pipe) );
+  ignore_pipe.sa_handler = SIG_IGN;
+  sigemptyset( &ignore_pipe.sa_mask );
+  sigaction( SIGPIPE, &ignore_pipe, &old_pipe );
+  // writes of at most PIPE_BUF bytes are atomic, so every child gets
+  // complete indices
+  uint32_t next = 0;
+  while ( next < jobs.size() ){
+    ssize_t len = write( job_pipe[1], &next, sizeof(next) );
+    if ( len == (ssize_t)sizeof(next) ){
+      ++next;
+    }
+    else if ( len < 0 && errno == EINTR ){
+      continue;
     }
     else {
-      folia::Document *result = 0;
-      try {
-	result = FrogFile( testName );
-      }
-      catch ( exception& e ){
-	LOG << "problem frogging: " << name << endl
-	    << e.what() << endl;
-	continue;
+      if ( errno == EPIPE ){
+	LOG << "no frog processes left to hand out files to" << endl;
       }
-      if ( !xmlOutName.empty() ){
-	if ( !result ){
-	  LOG << "FAILED to create FoLiA: " << xmlOutName << endl;
-	}
-	else {
-	  result->save( xmlOutName, options.doKanon );
-	  LOG << "FoLiA stored in " << xmlOutName << endl;
-	  delete result;
-	}
+      else {
+	LOG << "unable to hand out all files: " << strerror(errno) << endl;
       }
-      if ( !outName.empty() ){
-	LOG << "results stored in " << outName << endl;
-	if ( outS != &cout ){
-	  delete outS;
-	  outS = 0;
-	}
+      break;
+    }
+  }
+  close( job_pipe[1] );
+  sigaction( SIGPIPE, &old_pipe, 0 );
+  size_t done = 0;
+  size_t failed = 0;
+  TimerBlock total;
+  child_result res;
+  while ( read( result_pipe[0], &res, sizeof(res) ) == sizeof(res) ){
+    done += res.done;
+    failed += res.failed;
+    total.add( res.timers );
+  }
+  close( result_pipe[0] );
+  size_t crashed = 0;
+  for ( const auto& pid : children ){
+    int status = 0;
+    if ( waitpid( pid, &status, 0 ) < 0
+	 || !WIFEXITED(status)
+	 || WEXITSTATUS(status) != EXIT_SUCCESS ){
+      ++crashed;
+    }
+  }
+  wallTimer.stop();
+  struct rusage usage;
+  getrusage( RUSAGE_CHILDREN, &usage );
+  LOG << "frogged " << done << " of " << jobs.size() << " files, "
+      << failed << " failed, in " << wallTimer << endl;
+  LOG << "CPU time of all processes: "
+      << usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0
+      << " s user, "
+      << usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0
+      << " s system" << endl;
+  if ( !options.hide_timers && done > 0 ){
+    LOG << "timings are summed over " << children.size()
+	<< " processes" << endl;
+    show_timers( total, false );
+  }
+  if ( crashed > 0 ){
+    LOG << crashed << " frog processes terminated abnormally. "
+	<< "(use --retry to finish the remaining files)" << endl;
+  }
+}
+
+void FrogAPI::run_on_files(){
+  /// frog all files in options.fileNames
+  /*!
+    With options.numProcesses > 1 this is done by several processes in
+    parallel, when every file gets its own output.
+  */
+  if ( options.fileNames.size() > 1 ){
+    LOG << "start processing " << options.fileNames.size() << " files..." << endl;
+  }
+  bool parallel = options.numProcesses > 1;
+  if ( parallel ){
+    if ( options.test_API
+	 || !options.XMLoutFileName.empty()
+	 || !( options.noStdOut || ( outS == 0 && options.wantOUT ) ) ){
+      LOG << "--processes needs a separate output file per input file: "
+	  << "use --outputdir, --xmldir or --nostdout. Running "
+	  << "sequentially" << endl;
+      parallel = false;
+    }
+  }
+  if ( parallel ){
+    vector<file_job> jobs;
+    for ( auto const& name : options.fileNames ){
+      file_job job;
+      if ( prepare_file_job( name, job ) ){
+	jobs.push_back( job );
       }
-      if ( !options.outputFileName.empty() ){
-	LOG << "results stored in " << options.outputFileName << endl;
-	if ( outS != &cout ){
-	  delete outS;
-	  outS = 0;
-	}
+    }
+    if ( !jobs.empty() ){
+      run_files_parallel( jobs );
+    }
+  }
+  else {
+    for ( auto const& name : options.fileNames ){
+      file_job job;
+      if ( prepare_file_job( name, job ) ){
+	frog_file_job( job );
       }
     }
   }
+  write_stats();
   LOG << TiCC::Timer::now() << " Frog finished" << endl;
 }
 
@@ -1298,15 +1789,211 @@ void KillServerFun( int Signal ){
   }
 }
 
+void StopWorkerFun( int Signal ){
+  /// SIGTERM handler of a preforked server process: just stop accepting
+  if ( Signal == SIGTERM ){
+    StillRunning = false;
+  }
+}
+
+/// \brief a status message from a preforked server process to its parent
+struct worker_status {
+  pid_t pid;   ///< the process
+  char busy;   ///< 1 when it starts on a connection, 0 when done
+};
+
+void FrogAPI::server_worker( Sockets::ServerSocket& server, int status_fd ){
+  /// the main loop of one preforked server process
+  /*!
+    \param server the listening socket, shared by all server processes
+    \param status_fd the pipe to report our state to the parent
+
+    We accept and handle connections one at a time, until we are told to
+    stop, or until we handled options.serverMaxRequests connections. Then we
+    exit, and our parent starts a fresh process.
+
+    A SIGTERM interrupts a waiting accept(), but while a connection is
+    handled it is blocked, so that connection is finished first.
+  */
+  struct sigaction act;
+  sigemptyset( &act.sa_mask );
+  act.sa_handler = StopWorkerFun;
+  act.sa_flags = 0; // no SA_RESTART: we want accept() to return
+  sigaction( SIGTERM, &act, NULL );
+  sigset_t term_set;
+  sigemptyset( &term_set );
+  sigaddset( &term_set, SIGTERM );
+  int served = 0;
+  worker_status st;
+  st.pid = getpid();
+  while ( StillRunning
+	  && ( options.serverMaxRequests == 0
+	       || served < options.serverMaxRequests ) ){
+    Sockets::ClientSocket conn;
+    if ( !server.accept( conn ) ){
+      if ( StillRunning ){
+	LOG << "Accept failed: " << server.getMessage() << endl;
+	exit( EXIT_FAILURE );
+      }
+      break;
+    }
+    sigprocmask( SIG_BLOCK, &term_set, NULL );
+    st.busy = 1;
+    if ( write( status_fd, &st, sizeof(st) ) != sizeof(st) ){
+      // our parent is gone
+      exit( EXIT_FAILURE );
+    }
+    LOG << "New connection, socketid=" << conn.getSockId() << endl;
+    FrogServer( conn );
+    ++served;
+    st.busy = 0;
+    if ( write( status_fd, &st, sizeof(st) ) != sizeof(st) ){
+      exit( EXIT_FAILURE );
+    }
+    // a SIGTERM that arrived meanwhile is delivered here
+    sigprocmask( SIG_UNBLOCK, &term_set, NULL );
+  }
+  exit( EXIT_SUCCESS );
+}
+
+void FrogAPI::run_preforked_server( Sockets::ServerSocket& server ){
+  /// run a fixed pool of server processes, sharing the listening socket
+  /*!
+    \param server the listening socket
+
+    All processes share the models loaded by us. New connections wait in
+    the listen backlog until a process is free. We restart processes that
+    exit, either by recycling or by a crash, and regularly report the load.
+  */
+  int status_pipe[2];
+  if ( pipe( status_pipe ) != 0 ){
+    throw runtime_error( string("pipe() failed: ") + strerror(errno) );
+  }
+  map<pid_t,bool> workers; // pid -> busy
+  size_t connections = 0;  // in the current report interval
+  size_t total = 0;
+  size_t recycled = 0;
+  size_t max_busy = 0;
+  bool saturated = false;
+  const time_t report_interval = 60;
+  time_t last_report = time(0);
+  LOG << "starting " << options.serverWorkers << " server processes" << endl;
+  while ( StillRunning ){
+    // start new processes when needed
+    while ( workers.size() < size_t(options.serverWorkers) ){
+      pid_t pid = fork();
+      if ( pid < 0 ){
+	string err = strerror(errno);
+	LOG << "ERROR on fork: " << err << endl;
+	if ( workers.empty() ){
+	  throw runtime_error( "FORK failed: " + err );
+	}
+	break;
+      }
+      if ( pid == 0 ){
+	close( status_pipe[0] );
+	server_worker( server, status_pipe[1] );
+      }
+      workers[pid] = false;
+    }
+    struct pollfd pfd;
+    pfd.fd = status_pipe[0];
+    pfd.events = POLLIN;
+    int res = poll( &pfd, 1, 1000 );
+    if ( res > 0 ){
+      worker_status st;
+      if ( read( status_pipe[0], &st, sizeof(st) ) == sizeof(st) ){
+	auto it = workers.find( st.pid );
+	if ( it != workers.end() ){
+	  it->second = st.busy;
+	}
+	if ( st.busy ){
+	  ++connections;
+	  ++total;
+	}
+	size_t busy = 0;
+	for ( const auto& w : workers ){
+	  busy += w.second;
+	}
+	max_busy = max( max_busy, busy );
+	if ( busy == workers.size() && !saturated ){
+	  LOG << "all " << busy << " server processes are busy, new "
+	      << "connections are queued (backlog "
+	      << options.serverBacklog << ")" << endl;
+	}
+	saturated = ( busy == workers.size() );
+      }
+    }
+    // reap finished processes
+    int status;
+    pid_t pid;
+    while ( (pid = waitpid( -1, &status, WNOHANG )) > 0 ){
+      workers.erase( pid );
+      if ( WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS ){
+	++recycled;
+      }
+      else {
+	LOG << "server process " << pid << " terminated abnormally" << endl;
+      }
+    }
+    time_t now = time(0);
+    if ( now - last_report >= report_interval ){
+      size_t busy = 0;
+      for ( const auto& w : workers ){
+	busy += w.second;
+      }
+      LOG << "server load: " << busy << "/" << workers.size()
+	  << " processes busy, " << connections << " connections in the last "
+	  << now - last_report << " seconds (max " << max_busy
+	  << " busy), " << total << " in total, " << recycled
+	  << " processes recycled" << endl;
+      connections = 0;
+      max_busy = busy;
+      last_report = now;
+    }
+  }
+  // we are stopped. Tell the processes to finish their current connection.
+  // We repeat that every second, for a process that was just about to
+  // start waiting in accept() when the first signal arrived
+  for ( const auto& w : workers ){
+    kill( w.first, SIGTERM );
+  }
+  while ( !workers.empty() ){
+    pid_t pid = waitpid( -1, 0, WNOHANG );
+    if ( pid > 0 ){
+      workers.erase( pid );
+    }
+    else if ( pid < 0 && errno != EINTR ){
+      break;
+    }
+    else {
+      sleep( 1 );
+      for ( const auto& w : workers ){
+	kill( w.first, SIGTERM );
+      }
+    }
+  }
+  close( status_pipe[0] );
+  close( status_pipe[1] );
+}
+
 bool FrogAPI::run_a_server(){
-  //first set up some things to deal with zombies
+  /// run Frog as a server on options.listenport
+  /*!
+    With options.serverWorkers > 0 a fixed pool of preforked processes
+    handles the connections. Otherwise a new process is forked for every
+    connection.
+  */
   struct sigaction action;
-  action.sa_handler = SIG_IGN;
-  sigemptyset(&action.sa_mask);
+  if ( options.serverWorkers == 0 ){
+    //first set up some things to deal with zombies
+    action.sa_handler = SIG_IGN;
+    sigemptyset(&action.sa_mask);
 #ifdef SA_NOCLDWAIT
-  action.sa_flags = SA_NOCLDWAIT;
+    action.sa_flags = SA_NOCLDWAIT;
 #endif
-  sigaction(SIGCHLD, &action, NULL);
+    sigaction(SIGCHLD, &action, NULL);
+  }
   struct sigaction act;
   sigaction( SIGTERM, NULL, &act ); // get current action
   act.sa_handler = KillServerFun;
@@ -1322,30 +2009,36 @@ bool FrogAPI::run_a_server(){
     if ( !server.connect( options.listenport ) ){
       throw( runtime_error( "starting server on port " + options.listenport + " failed" ) );
     }
-    if ( !server.listen( 5 ) ) {
-      // maximum of 5 pending requests
-      throw( runtime_error( "listen(5) failed" ) );
-    }
-    while ( StillRunning ) {
-      Sockets::ClientSocket conn;
-      if ( server.accept( conn ) ){
-	LOG << "New connection, socketid=" << conn.getSockId() << endl;
-	int pid = fork();
-	if (pid < 0) {
-	  string err = strerror(errno);
-	  LOG << "ERROR on fork: " << err << endl;
-	  throw runtime_error( "FORK failed: " + err );
+    if ( !server.listen( options.serverBacklog ) ) {
+      throw( runtime_error( "listen(" + TiCC::toString(options.serverBacklog)
+			    + ") failed" ) );
+    }
+    if ( options.serverWorkers > 0 ){
+      run_preforked_server( server );
+    }
+    else {
+      while ( StillRunning ) {
+	Sockets::ClientSocket conn;
+	if ( server.accept( conn ) ){
+	  LOG << "New connection, socketid=" << conn.getSockId() << endl;
+	  int pid = fork();
+	  if (pid < 0) {
+	    string err = strerror(errno);
+	    LOG << "ERROR on fork: " << err << endl;
+	    throw runtime_error( "FORK failed: " + err );
+	  }
+	  else if (pid == 0)  {
+	    FrogServer( conn );
+	    return true;
+	  }
 	}
-	else if (pid == 0)  {
-	  FrogServer( conn );
-	  return true;
+	else {
+	  throw( runtime_error( "Accept failed" ) );
 	}
       }
-      else {
-	throw( runtime_error( "Accept failed" ) );
-      }
     }
     LOG << TiCC::Timer::now() << " server terminated by SIGTERM" << endl;
+    write_stats();
   }
   catch ( exception& e ) {
     LOG << "Server error:" << e.what() << " Exiting." << endl;
@@ -1360,6 +2053,7 @@ folia::processor *FrogAPI::add_provenance( folia::Document& doc ) const {
     \param doc The folia::Document.
     \return an instantiated folia::processor associated with Frog
    */
+  wait_for_modules(); // we need the versions of all modules
   string _label = "frog";
   vector<folia::processor *> procs = doc.get_processors_by_name( _label );
   if ( !procs.empty() ){
@@ -1471,6 +2165,7 @@ void FrogAPI::append_to_sentence( folia::Sentence *sent,
     }
   }
   else {
+    wait_for_modules(); // a no-op, unless the sentence wasn't frogged
     if ( options.doTagger ){
       myCGNTagger->add_tags( wv, fd );
     }
@@ -1584,6 +2279,7 @@ void FrogAPI::append_to_words( const vector<folia::Word*>& wv,
     }
   }
   else {
+    wait_for_modules(); // a no-op, unless the sentence wasn't frogged
     if ( options.doTagger ){
       myCGNTagger->add_tags( wv, fd );
     }
@@ -1616,6 +2312,103 @@ void FrogAPI::append_to_words( const vector<folia::Word*>& wv,
   }
 }
 
+/// \brief a streambuf reading lines from a socket, up to an 'EOT' line
+///
+/// This lets the tokenizer consume a request while it is still arriving.
+class socket_linebuf: public std::streambuf {
+public:
+  socket_linebuf( Sockets::ClientSocket& c, const string& first ):
+    conn(c), pending(first), at_end(false){}
+protected:
+  int_type underflow() override {
+    if ( gptr() < egptr() ){
+      return traits_type::to_int_type( *gptr() );
+    }
+    string line;
+    if ( !pending.empty() ){
+      line.swap( pending );
+    }
+    else if ( at_end || !conn.read( line ) ){
+      at_end = true;
+      return traits_type::eof();
+    }
+    if ( line == "EOT" ){
+      at_end = true;
+      return traits_type::eof();
+    }
+    buffer = line + "\n";
+    setg( &buffer[0], &buffer[0], &buffer[0] + buffer.size() );
+    return traits_type::to_int_type( *gptr() );
+  }
+private:
+  Sockets::ClientSocket& conn;
+  string buffer;
+  string pending;
+  bool at_end;
+};
+
+static void send_partial( Sockets::ClientSocket& conn,
+			  ostringstream& os ){
+  /// send the content of \e os to the client, and clear it
+  /*!
+    \param conn the connection
+    \param os the collected output
+
+    The socket is blocking, so a slow client automatically slows us down.
+  */
+  if ( !conn.write( os.str() ) ){
+    throw runtime_error( "write to client failed: " + conn.getMessage() );
+  }
+  os.str( "" );
+}
+
+static bool is_stats_request( const string& data ){
+  /// check if the client only asks for the statistics
+  /*!
+    \param data the request
+    \return true when \e data consists of a single '#stats' line
+  */
+  return TiCC::trim( data ) == "#stats";
+}
+
+void FrogAPI::stream_text( Sockets::ClientSocket& conn,
+			   ostringstream& output_stream,
+			   const string& first_line ){
+  /// frog text from the client up to an 'EOT' line, sending the results of
+  /// every sentence as soon as they are available
+  /*!
+    \param conn the connection
+    \param output_stream scratch space for the results
+    \param first_line a line already read from the connection
+  */
+  socket_linebuf sb( conn, first_line );
+  istream is( &sb );
+  timers.tokTimer.start();
+  vector<Tokenizer::Token> toks = tokenizer->tokenize_stream( is );
+  timers.tokTimer.stop();
+  // the size of the request is unknown, so always use the workers (if any)
+  serial_only = false;
+  start_pipeline();
+  try {
+    while ( toks.size() > 0 ){
+      dispatch_sentence( extract_fd( toks, false ),
+			 1,
+			 [this,&conn,&output_stream]( frog_data& res ){
+			   show_results( output_stream, res );
+			   send_partial( conn, output_stream );
+			 } );
+      timers.tokTimer.start();
+      toks = tokenizer->tokenize_stream_next();
+      timers.tokTimer.stop();
+    }
+    finish_pipeline();
+  }
+  catch ( ... ){
+    stop_pipeline();
+    throw;
+  }
+}
+
 void FrogAPI::FrogServer( Sockets::ClientSocket &conn ){
   /// Run a server
   /*!
@@ -1624,7 +2417,13 @@ void FrogAPI::FrogServer( Sockets::ClientSocket &conn ){
     The 'conn' object should be correctly set up using the right parameters.
     Depending on the Frog settings we can serve text, FoLiA and JSON.
     At the moment only TCP connections are supported.
+
+    Requests of at least options.serverParallelMin bytes are frogged by
+    options.numWorkers workers, smaller ones sentence by sentence.
   */
+#ifdef HAVE_OPENMP
+  omp_set_num_threads( options.numThreads );
+#endif
   try {
     while ( conn.isValid() ) {
       ostringstream output_stream;
@@ -1645,10 +2444,8 @@ void FrogAPI::FrogServer( Sockets::ClientSocket &conn ){
         if ( options.debugFlag > 5 ){
 	  DBG << "received data [" << result << "]" << endl;
 	}
-	TiCC::tmp_stream ts( "frog" );
-	ts.os() << result << endl;
-	ts.close();
-	folia::Document *xml = run_folia_engine( ts.tmp_name(), output_stream );
+	serial_only = result.size() < size_t(options.serverParallelMin);
+	folia::Document *xml = run_folia_engine( result, output_stream, true );
 	if ( xml && options.doXMLout ){
 	  xml->set_canonical(options.doKanon);
 	  output_stream << xml;
@@ -1687,21 +2484,66 @@ void FrogAPI::FrogServer( Sockets::ClientSocket &conn ){
 	  if ( options.debugFlag ){
 	    DBG << "Parsed JSON: " << the_json << endl;
 	  }
-	  for ( const auto& it : the_json ){
-	    UnicodeString data = TiCC::UnicodeFromUTF8(it["sentence"]);
-	    timers.tokTimer.start();
-	    vector<Tokenizer::Token> toks = tokenizer->tokenize_line( data );
-	    timers.tokTimer.stop();
-	    while ( toks.size() > 0 ){
-	      frog_data sent = frog_sentence( toks, 1 );
-	      show_results( output_stream, sent );
-	      timers.tokTimer.start();
-	      toks = tokenizer->tokenize_next();
-	      timers.tokTimer.stop();
+	  if ( the_json.is_object()
+	       && the_json.value( "command", "" ) == "stats" ){
+	    output_stream << stats_json().dump() << endl;
+	  }
+	  else {
+	    if ( the_json.is_object() ){
+	      // a single entry instead of a batch
+	      the_json = json::array( { the_json } );
+	    }
+	    // the entries of a batch are spread over the workers. The results
+	    // are still sent in the order of the request
+	    serial_only = json_line.size() < size_t(options.serverParallelMin);
+	    start_pipeline();
+	    try {
+	      size_t s_count = 0;
+	      for ( const auto& it : the_json ){
+		// an entry may carry an id, which is added to all its results
+		json id = it.value( "id", json() );
+		UnicodeString data = TiCC::UnicodeFromUTF8(it["sentence"]);
+		timers.tokTimer.start();
+		vector<Tokenizer::Token> toks = tokenizer->tokenize_line( data );
+		timers.tokTimer.stop();
+		while ( toks.size() > 0 ){
+		  dispatch_sentence( extract_fd( toks, false ),
+				     ++s_count,
+				     [this,&conn,&output_stream,id]( frog_data& res ){
+				       output_JSON( output_stream, res,
+						    options.JSON_pp,
+						    id.is_null() ? 0 : &id );
+				       if ( options.serverStream ){
+					 send_partial( conn, output_stream );
+				       }
+				     } );
+		  timers.tokTimer.start();
+		  toks = tokenizer->tokenize_next();
+		  timers.tokTimer.stop();
+		}
+	      }
+	      finish_pipeline();
+	    }
+	    catch ( ... ){
+	      stop_pipeline();
+	      throw;
 	    }
 	  }
 	}
       }
+      else if ( options.serverStream && !options.doSentencePerLine ){
+	string first_line;
+	if ( !conn.read( first_line ) ){
+	  throw( runtime_error( "read failed" ) );
+	}
+	if ( is_stats_request( first_line ) ){
+	  output_stream << stats_json().dump() << endl;
+	}
+	else {
+	  LOG << TiCC::Timer::now() << " Processing a stream... " << endl;
+	  stream_text( conn, output_stream, first_line );
+	}
+      }
       else {
         string data = "";
         if ( options.doSentencePerLine ){
@@ -1725,41 +2567,62 @@ void FrogAPI::FrogServer( Sockets::ClientSocket &conn ){
         if ( options.debugFlag > 5 ){
 	  DBG << "Received: [" << data << "]" << endl;
 	}
-        LOG << TiCC::Timer::now() << " Processing... " << endl;
-	folia::Document *doc = 0;
-	folia::FoliaElement *root = 0;
-	unsigned int par_count = 0;
-	if ( options.doXMLout ){
-	  string doc_id = options.docid;
-	  if ( doc_id.empty() ){
-	    doc_id = "untitled";
-	  }
-	  root = start_document( doc_id, doc );
+	if ( is_stats_request( data ) ){
+	  output_stream << stats_json().dump() << endl;
 	}
-	timers.tokTimer.start();
-	// start tokenizing
-	// tokenize_data() delivers the first sentence, call
-	//  tokenize_next() multiple times to get all sentences!
-	vector<Tokenizer::Token> toks = tokenizer->tokenize_data( data );
-	timers.tokTimer.stop();
-	while ( toks.size() > 0 ){
-	  frog_data sent = frog_sentence( toks, 1 );
+	else {
+	  LOG << TiCC::Timer::now() << " Processing... " << endl;
+	  folia::Document *doc = 0;
+	  folia::FoliaElement *root = 0;
+	  unsigned int par_count = 0;
 	  if ( options.doXMLout ){
-	    root = append_to_folia( root, sent, par_count );
-	  }
-	  else {
-	    show_results( output_stream, sent );
+	    string doc_id = options.docid;
+	    if ( doc_id.empty() ){
+	      doc_id = "untitled";
+	    }
+	    root = start_document( doc_id, doc );
 	  }
 	  timers.tokTimer.start();
-	  toks = tokenizer->tokenize_next();
+	  // start tokenizing
+	  // tokenize_data() delivers the first sentence, call
+	  //  tokenize_next() multiple times to get all sentences!
+	  vector<Tokenizer::Token> toks = tokenizer->tokenize_data( data );
 	  timers.tokTimer.stop();
+	  serial_only = data.size() < size_t(options.serverParallelMin);
+	  start_pipeline();
+	  try {
+	    while ( toks.size() > 0 ){
+	      dispatch_sentence( extract_fd( toks, false ),
+				 1,
+				 [this,&conn,&output_stream,&root,&par_count]( frog_data& res ){
+				   if ( options.doXMLout ){
+				     root = append_to_folia( root, res, par_count );
+				   }
+				   else {
+				     show_results( output_stream, res );
+				     if ( options.serverStream ){
+				       send_partial( conn, output_stream );
+				     }
+				   }
+				 } );
+	      timers.tokTimer.start();
+	      toks = tokenizer->tokenize_next();
+	      timers.tokTimer.stop();
+	    }
+	    finish_pipeline();
+	  }
+	  catch ( ... ){
+	    stop_pipeline();
+	    delete doc;
+	    throw;
+	  }
+	  if ( options.doXMLout && doc ){
+	    doc->set_canonical(options.doKanon);
+	    output_stream << doc;
+	    delete doc;
+	  }
+	  //	DBG << "Done Processing... " << endl;
 	}
-	if ( options.doXMLout && doc ){
-	  doc->set_canonical(options.doKanon);
-	  output_stream << doc;
-	  delete doc;
-	}
-	//	DBG << "Done Processing... " << endl;
       }
       if ( options.doJSONout ){
         if ( options.debugFlag > 5 ){
@@ -1935,6 +2798,7 @@ void FrogAPI::run_interactive(){
     cout << "Done.\n";
   }
 #endif
+  write_stats();
 }
 
 string FrogAPI::Frogtostring( const string& s ){
@@ -2052,6 +2916,24 @@ frog_data FrogAPI::frog_sentence( vector<Tokenizer::Token>& sent,
     DBG << "tokens:\n" << sent << endl;
   }
   frog_data sentence = extract_fd( sent, no_eos );
+  frog_one_sentence( sentence, s_count, *contexts[0] );
+  return sentence;
+}
+
+void FrogAPI::frog_one_sentence( frog_data& sentence,
+				 const size_t s_count,
+				 worker_context& ctx ){
+  /// run all enabled modules on 1 (tokenized) sentence
+  /*!
+    \param sentence the frog_data to enrich. Sentences in another language
+    than the default language are left as they are.
+    \param s_count holds the sentence count (for diagnostics)
+    \param ctx the context of the calling worker
+
+    This function may run in several worker threads at once. The taggers,
+    MBMA and MBLEM are reentrant, using the scratch space in \e ctx.
+    The MWU resolver and the Parser are still protected by a lock.
+  */
   if ( options.debugFlag > 0 ){
     DBG << "sentence:\n" << sentence << endl;
   }
@@ -2070,143 +2952,308 @@ frog_data FrogAPI::frog_sentence( vector<Tokenizer::Token>& sent,
       DBG << "skipping sentence " << s_count << " (different language: " << lan
 	   << " --language=" << def_lang << ")" << endl;
     }
-    return sentence;
+    return;
   }
-  else {
-    timers.frogTimer.start();
-    if ( options.debugFlag > 5 ){
-      DBG << "Frogging sentence:\n" << sentence << endl;
-      DBG << "tokenized text = " << sentence.sentence() << endl;
-    }
-    bool all_well = true;
-    string exs;
-    timers.tagTimer.start();
-    try {
-      myCGNTagger->Classify( sentence );
-    }
-    catch ( exception&e ){
-      all_well = false;
-      exs += string(e.what()) + " ";
-    }
-    timers.tagTimer.stop();
-    if ( !all_well ){
-      throw runtime_error( exs );
-    }
-    for ( auto& word : sentence.units ) {
-#pragma omp parallel sections
-      {
-	// Lemmatization and Mophological analysis can be done in parallel
-	// per word
+  ctx.timers.frogTimer.start();
+  stats_clock::time_point sentence_start = stats_clock::now();
+  if ( options.debugFlag > 5 ){
+    DBG << "Frogging sentence:\n" << sentence << endl;
+    DBG << "tokenized text = " << sentence.sentence() << endl;
+  }
+  bool all_well = true;
+  string exs;
+  ctx.timers.tagTimer.start();
+  stats_clock::time_point tag_start = stats_clock::now();
+  try {
+    myCGNTagger->Classify( sentence );
+  }
+  catch ( exception&e ){
+    all_well = false;
+    exs += string(e.what()) + " ";
+  }
+  add_stat( FrogStats::TAGGER, tag_start );
+  ctx.timers.tagTimer.stop();
+  if ( !all_well ){
+    throw runtime_error( exs );
+  }
+  // when running in a pipeline, the workers already keep all threads busy
+#pragma omp parallel sections if( !pipeline )
+  {
+    // Lemmatization and Mophological analysis can be done in parallel,
+    // each handling the whole sentence in one go
 #pragma omp section
-	{
-	  if ( options.doMbma ){
-	    timers.mbmaTimer.start();
-	    if (options.debugFlag > 1){
-	      DBG << "Calling mbma..." << endl;
-	    }
-	    try {
-	      myMbma->Classify( word );
-	    }
-	    catch ( exception& e ){
-	      all_well = false;
-	      exs += string(e.what()) + " ";
-	    }
-	    timers.mbmaTimer.stop();
+    {
+      if ( options.doMbma ){
+	ctx.timers.mbmaTimer.start();
+	stats_clock::time_point stage_start = stats_clock::now();
+	if (options.debugFlag > 1){
+	  DBG << "Calling mbma..." << endl;
+	}
+	try {
+	  wait_for( mbma_loader );
+	  if ( !ctx.mbma ){
+	    // with lazy init, the context is created without MBMA
+	    ctx.mbma = myMbma->create_context();
 	  }
+	  myMbma->Classify( sentence, *ctx.mbma );
+	}
+	catch ( exception& e ){
+	  all_well = false;
+	  exs += string(e.what()) + " ";
 	}
+	add_stat( FrogStats::MBMA, stage_start );
+	ctx.timers.mbmaTimer.stop();
+      }
+    }
 #pragma omp section
-	{
-	  if ( options.doLemma ){
-	    timers.mblemTimer.start();
-	    if (options.debugFlag > 1) {
-	      DBG << "Calling mblem..." << endl;
-	    }
-	    try {
-	      myMblem->Classify( word );
-	    }
-	    catch ( exception&e ){
-	      all_well = false;
-	      exs += string(e.what()) + " ";
-	    }
-	    timers.mblemTimer.stop();
+    {
+      if ( options.doLemma ){
+	ctx.timers.mblemTimer.start();
+	stats_clock::time_point stage_start = stats_clock::now();
+	if (options.debugFlag > 1) {
+	  DBG << "Calling mblem..." << endl;
+	}
+	try {
+	  wait_for( mblem_loader );
+	  if ( !ctx.mblem ){
+	    ctx.mblem = myMblem->create_context();
 	  }
+	  myMblem->Classify( sentence, *ctx.mblem );
+	}
+	catch ( exception&e ){
+	  all_well = false;
+	  exs += string(e.what()) + " ";
 	}
-      } // omp parallel sections
-    } //for all words
-    if ( !all_well ){
-      throw runtime_error( exs );
+	add_stat( FrogStats::MBLEM, stage_start );
+	ctx.timers.mblemTimer.stop();
+      }
     }
-    //    cout << endl;
-#pragma omp parallel sections
-    {
-      // NER and IOB tagging can be done in parallel, per Sentence
+  } // omp parallel sections
+  if ( !all_well ){
+    throw runtime_error( exs );
+  }
+  //    cout << endl;
+#pragma omp parallel sections if( !pipeline )
+  {
+    // NER and IOB tagging can be done in parallel, per Sentence
 #pragma omp section
-      {
-	if ( options.doNER ){
-	  timers.nerTimer.start();
-	  if (options.debugFlag > 1) {
-	    DBG << "Calling NER..." << endl;
-	  }
-	  try {
-	    myNERTagger->Classify( sentence );
-	  }
-	  catch ( exception&e ){
-	    all_well = false;
-	    exs += string(e.what()) + " ";
-	  }
-	  timers.nerTimer.stop();
+    {
+      if ( options.doNER ){
+	ctx.timers.nerTimer.start();
+	stats_clock::time_point stage_start = stats_clock::now();
+	if (options.debugFlag > 1) {
+	  DBG << "Calling NER..." << endl;
+	}
+	try {
+	  wait_for( ner_loader );
+	  myNERTagger->Classify( sentence );
+	}
+	catch ( exception&e ){
+	  all_well = false;
+	  exs += string(e.what()) + " ";
 	}
+	add_stat( FrogStats::NER, stage_start );
+	ctx.timers.nerTimer.stop();
       }
+    }
 #pragma omp section
-      {
-	if ( options.doIOB ){
-	  timers.iobTimer.start();
-	  try {
-	    myIOBTagger->Classify( sentence );
-	  }
-	  catch ( exception&e ){
-	    all_well = false;
-	    exs += string(e.what()) + " ";
-	  }
-	  timers.iobTimer.stop();
+    {
+      if ( options.doIOB ){
+	ctx.timers.iobTimer.start();
+	stats_clock::time_point stage_start = stats_clock::now();
+	try {
+	  wait_for( iob_loader );
+	  myIOBTagger->Classify( sentence );
 	}
+	catch ( exception&e ){
+	  all_well = false;
+	  exs += string(e.what()) + " ";
+	}
+	add_stat( FrogStats::IOB, stage_start );
+	ctx.timers.iobTimer.stop();
       }
     }
-    //
-    // MWU resolution needs the previous results per sentence
-    // AND must be done before parsing
-    //
-    if ( !all_well ){
-      throw runtime_error( exs );
+  }
+  //
+  // MWU resolution needs the previous results per sentence
+  // AND must be done before parsing
+  //
+  if ( !all_well ){
+    throw runtime_error( exs );
+  }
+  if ( options.doMwu ){
+    if ( !sentence.empty() ){
+      wait_for( mwu_loader );
+      ctx.timers.mwuTimer.start();
+      stats_clock::time_point stage_start = stats_clock::now();
+      lock_guard<mutex> guard( mwu_lock );
+      myMwu->Classify( sentence );
+      add_stat( FrogStats::MWU, stage_start );
+      ctx.timers.mwuTimer.stop();
     }
-    if ( options.doMwu ){
-      if ( !sentence.empty() ){
-	timers.mwuTimer.start();
-	myMwu->Classify( sentence );
-	timers.mwuTimer.stop();
+  }
+  if ( options.doAlpino || options.doParse ){
+    if ( options.maxParserTokens == 0
+	 || sentence.size() <= options.maxParserTokens ){
+      wait_for( parser_loader );
+      unique_lock<mutex> guard( parser_lock, defer_lock );
+      stats_clock::time_point stage_start = stats_clock::now();
+      if ( !myParser->thread_safe() ){
+	guard.lock();
       }
+      myParser->Parse( sentence, ctx.timers );
+      add_stat( FrogStats::PARSER, stage_start );
     }
-    if ( options.doAlpino || options.doParse ){
-      if ( options.maxParserTokens == 0
-	   || sentence.size() <= options.maxParserTokens ){
-	myParser->Parse( sentence, timers );
-      }
-      else {
-	LOG << "WARNING!" << endl;
-	LOG << "Sentence " << s_count
-	    << " isn't parsed because it contains more tokens ("
-	    << sentence.size()
-	    << ") then set with the --max-parser-tokens="
-	    << options.maxParserTokens << " option." << endl;
-	DBG << 	"Sentence " << s_count << " is too long: " << endl
-	    << sentence.sentence(true) << endl;
-      }
+    else {
+      LOG << "WARNING!" << endl;
+      LOG << "Sentence " << s_count
+	  << " isn't parsed because it contains more tokens ("
+	  << sentence.size()
+	  << ") then set with the --max-parser-tokens="
+	  << options.maxParserTokens << " option." << endl;
+      DBG << 	"Sentence " << s_count << " is too long: " << endl
+	  << sentence.sentence(true) << endl;
     }
-    timers.frogTimer.stop();
-    if ( options.debugFlag > 5 ){
-      DBG << "Frogged one sentence:" << endl << sentence << endl;
+  }
+  ctx.timers.frogTimer.stop();
+  if ( stats ){
+    stats->add_sentence( sentence.size(), usecs_since( sentence_start ) );
+  }
+  if ( options.debugFlag > 5 ){
+    DBG << "Frogged one sentence:" << endl << sentence << endl;
+  }
+}
+
+void FrogAPI::start_pipeline(){
+  /// start a SentencePipeline, when more than 1 worker is requested
+  if ( options.numWorkers > 1 && !pipeline && !serial_only ){
+    pipeline = new SentencePipeline( options.numWorkers,
+				     4 * options.numWorkers,
+				     [this]( frog_data& fd,
+					     size_t s_count,
+					     size_t id ){
+				       frog_one_sentence( fd,
+							  s_count,
+							  *contexts[id] );
+				     } );
+    if ( options.debugFlag > 0 ){
+      DBG << "started a pipeline with " << pipeline->workers()
+	  << " workers" << endl;
     }
-    return sentence;
+  }
+}
+
+void FrogAPI::finish_pipeline(){
+  /// deliver all pending sentences and stop the pipeline (if any)
+  if ( pipeline ){
+    pipeline->flush();
+    stop_pipeline();
+  }
+}
+
+void FrogAPI::stop_pipeline(){
+  /// stop the pipeline (if any) discarding all pending sentences
+  delete pipeline;
+  pipeline = 0;
+}
+
+void FrogAPI::dispatch_sentence( frog_data&& sentence,
+				 const size_t s_count,
+				 const function<void(frog_data&)>& done ){
+  /// frog a sentence and hand it over to \e done
+  /*!
+    \param sentence the (tokenized) sentence to frog
+    \param s_count the sentence count (for diagnostics)
+    \param done the function that handles the result
+
+    When a pipeline is active, the sentence is queued and \e done is
+    called later, but always in the order in which the sentences were
+    dispatched. Otherwise the sentence is frogged and handled immediately.
+  */
+  if ( pipeline ){
+    pipeline->submit( std::move(sentence), s_count, done );
+  }
+  else {
+    frog_one_sentence( sentence, s_count, *contexts[0] );
+    done( sentence );
+  }
+}
+
+void FrogAPI::add_stat( FrogStats::stage s,
+			const stats_clock::time_point& start ) const {
+  /// register the time one stage took for one sentence
+  /*!
+    \param s the stage
+    \param start the moment the stage started
+  */
+  if ( stats ){
+    stats->add( s, usecs_since( start ) );
+  }
+}
+
+json FrogAPI::stats_json() const {
+  /// return the statistics as JSON
+  /*!
+    The latencies, rates and sentence lengths are those of all processes
+    fork()ed from us. The cache statistics are those of the current process
+  */
+  json result;
+  if ( stats ){
+    result = stats->to_json();
+  }
+  result["pid"] = getpid();
+  json caches = json::object();
+  size_t hits = 0;
+  size_t misses = 0;
+  if ( myMbma && myMbma->cache_counts( hits, misses ) ){
+    caches["mbma"] = { { "hits", hits }, { "misses", misses } };
+  }
+  if ( myMblem && myMblem->cache_counts( hits, misses ) ){
+    caches["lemmatizer"] = { { "hits", hits }, { "misses", misses } };
+  }
+  for ( auto& it : caches.items() ){
+    json& cache = it.value();
+    size_t total = cache["hits"].get<size_t>() + cache["misses"].get<size_t>();
+    cache["hit_rate"] = ( total > 0 ? cache["hits"].get<double>() / total
+			  : 0.0 );
+  }
+  result["caches"] = caches;
+  return result;
+}
+
+void FrogAPI::write_stats() const {
+  /// write the statistics to options.statsFile (if set)
+  if ( options.statsFile.empty() ){
+    return;
+  }
+  wait_for_modules();
+  ofstream os( options.statsFile );
+  if ( !os ){
+    LOG << "unable to write the statistics to: " << options.statsFile << endl;
+    return;
+  }
+  os << stats_json().dump( 2 ) << endl;
+  LOG << "statistics written to: " << options.statsFile << endl;
+}
+
+void FrogAPI::reset_stats(){
+  /// clear the statistics, e.g. between benchmark runs
+  if ( stats ){
+    stats->reset();
+  }
+  if ( myMbma ){
+    myMbma->reset_cache_counts();
+  }
+  if ( myMblem ){
+    myMblem->reset_cache_counts();
+  }
+}
+
+void FrogAPI::collect_timers(){
+  /// add the timings of all workers to our own timers, and reset them
+  for ( const auto& ctx : contexts ){
+    timers.add( ctx->timers );
+    ctx->timers.reset();
   }
 }
 
@@ -2325,15 +3372,20 @@ void FrogAPI::output_tabbed( ostream& os, const frog_record& fd ) const {
 
 void FrogAPI::output_JSON( ostream& os,
 			   const frog_data& fd,
-			   int pp_val ) const {
+			   int pp_val,
+			   const json *id ) const {
   /// output a frog_data structure as JSON
   /*!
     \param os the output stream
     \param fd the frog_data to display
     \param pp_val value to use for formatted output.
+    \param id an (optional) id, as provided by the client
 
     If pp_val is 0, the whole JSON is output as a (very) long string.
     If pp_val > 0, the JSON is formatted neatly with pp_val as indentation
+
+    Without an id, the output is the array of words. With an id, it is an
+    object with the id and that array as "words".
   */
   json out_json = json::array();
   if ( fd.mw_units.empty() ){
@@ -2350,6 +3402,12 @@ void FrogAPI::output_JSON( ostream& os,
       out_json.push_back( part );
     }
   }
+  if ( id ){
+    json tmp = json::object();
+    tmp["id"] = *id;
+    tmp["words"] = out_json;
+    out_json = tmp;
+  }
   if ( options.debugFlag ){
     DBG << "spitting out JSON:" << out_json << endl;
   }
@@ -2446,16 +3504,19 @@ void FrogAPI::handle_word_vector( ostream& os,
   }
   //  cerr << "tokens:" << toks << " size=" << toks.size() << endl;
   if ( toks.size() == wv.size() ){
-    frog_data res = frog_sentence( toks, s_cnt );
-    //    cerr << "res:" << res << " size=" << res.size() << endl;
-    if ( res.size() > 0 ){
-      if ( !options.noStdOut ){
-	show_results( os, res );
-      }
-      if ( options.doXMLout ){
-	append_to_words( wv, res );
-      }
-    }
+    dispatch_sentence( extract_fd( toks, false ),
+		       s_cnt,
+		       [this,&os,wv]( frog_data& res ){
+			 //    cerr << "res:" << res << " size=" << res.size() << endl;
+			 if ( res.size() > 0 ){
+			   if ( !options.noStdOut ){
+			     show_results( os, res );
+			   }
+			   if ( options.doXMLout ){
+			     append_to_words( wv, res );
+			   }
+			 }
+		       } );
   }
   else {
     string msg = parent->doc()->filename() + ": unable to frog: " + parent->id()
@@ -2518,21 +3579,27 @@ void FrogAPI::handle_one_sentence( ostream& os,
 	toks = tokenizer->tokenize_next();
       }
       timers.tokTimer.stop();
-      frog_data sent = frog_sentence( all_toks, s_cnt, true );
-      if ( !options.noStdOut ){
-	show_results( os, sent );
-      }
-      append_to_sentence( s, sent );
+      dispatch_sentence( extract_fd( all_toks, true ),
+			 s_cnt,
+			 [this,&os,s]( frog_data& sent ){
+			   if ( !options.noStdOut ){
+			     show_results( os, sent );
+			   }
+			   append_to_sentence( s, sent );
+			 } );
     }
     else {
       timers.tokTimer.start();
       vector<Tokenizer::Token> toks = tokenizer->tokenize_line( text, sent_lang );
       timers.tokTimer.stop();
       while ( toks.size() > 0 ){
-	frog_data sent = frog_sentence( toks, s_cnt );
-	if ( !options.noStdOut ){
-	  show_results( os, sent );
-	}
+	dispatch_sentence( extract_fd( toks, false ),
+			   s_cnt,
+			   [this,&os]( frog_data& sent ){
+			     if ( !options.noStdOut ){
+			       show_results( os, sent );
+			     }
+			   } );
 	timers.tokTimer.start();
 	toks = tokenizer->tokenize_next();
 	timers.tokTimer.stop();
@@ -2572,24 +3639,23 @@ void FrogAPI::handle_one_paragraph( ostream& os,
       vector<Tokenizer::Token> toks = tokenizer->tokenize_line( text );
       timers.tokTimer.stop();
       while ( toks.size() > 0 ){
-	frog_data res = frog_sentence( toks, ++sentences_done );
-	while ( !res.empty() ){
-	  if ( !options.noStdOut ){
-	    show_results( os, res );
-	  }
-	  if ( options.doXMLout ){
-	    folia::KWargs args;
-	    string p_id = p->id();
-	    if ( !p_id.empty() ){
-	      args["generate_id"] = p_id;
-	    }
-	    folia::Sentence *s = p->add_child<folia::Sentence>( args );
-	    append_to_sentence( s, res );
-	  }
-	  if ( toks.size() == 0 ){
-	    break;
-	  }
-	  res = frog_sentence( toks, ++sentences_done );
+	while ( toks.size() > 0 ){
+	  dispatch_sentence( extract_fd( toks, false ),
+			     ++sentences_done,
+			     [this,&os,p]( frog_data& sent ){
+			       if ( !options.noStdOut ){
+				 show_results( os, sent );
+			       }
+			       if ( options.doXMLout ){
+				 folia::KWargs args;
+				 string p_id = p->id();
+				 if ( !p_id.empty() ){
+				   args["generate_id"] = p_id;
+				 }
+				 folia::Sentence *s = p->add_child<folia::Sentence>( args );
+				 append_to_sentence( s, sent );
+			       }
+			     } );
 	}
 	timers.tokTimer.start();
 	toks = tokenizer->tokenize_next();
@@ -2625,6 +3691,79 @@ void FrogAPI::handle_one_paragraph( ostream& os,
   }
 }
 
+void FrogAPI::append_sentences( folia::FoliaElement *e,
+				const vector<frog_data>& sents ) const {
+  /// add a list of frogged sentences to a FoLiA element
+  /*!
+    \param e the FoliaElement the text of the sentences came from
+    \param sents the frogged sentences
+
+    When there is more than one sentence, they are wrapped in a new Paragraph,
+    when that is allowed.
+  */
+  if ( sents.size() == 0 ){
+    // might happen in rare cases
+    // just skip
+  }
+  else if ( sents.size() > 1 ){
+    // multiple sentences. We need an extra Paragraph. when allowed
+    if ( e->acceptable<folia::Paragraph>() ){
+      folia::KWargs p_args;
+      string e_id = e->id();
+      if ( !e_id.empty() ){
+	p_args["generate_id"] = e_id;
+      }
+      folia::Paragraph *p = e->add_child<folia::Paragraph>( p_args );
+      for ( const auto& sent : sents ){
+	folia::KWargs args;
+	string p_id = p->id();
+	if ( !p_id.empty() ){
+	  args["generate_id"] = p_id;
+	}
+	folia::Sentence *s = p->add_child<folia::Sentence>( args );
+	append_to_sentence( s, sent );
+	if  (options.debugFlag > 0){
+	  DBG << "created a new sentence: " << s << endl;
+	}
+      }
+    }
+    else {
+      if ( options.debugFlag > 5 ){
+	DBG << "not e->acceptable\n" << e << endl;
+      }
+      for ( const auto& sent : sents ){
+	folia::KWargs args;
+	string e_id = e->id();
+	if ( !e_id.empty() ){
+	  args["generate_id"] = e_id;
+	}
+	folia::Sentence *s = e->add_child<folia::Sentence>( args );
+	append_to_sentence( s, sent );
+	if  (options.debugFlag > 0){
+	  DBG << "created a new sentence: " << s << endl;
+	}
+      }
+    }
+  }
+  else {
+    // 1 sentence, connect directly.
+    folia::KWargs args;
+    string e_id = e->id();
+    if ( e_id.empty() ){
+      e_id = e->generateId( e->xmltag() );
+      args["xml:id"] = e_id + ".s.1";
+    }
+    else {
+      args["generate_id"] = e_id;
+    }
+    folia::Sentence *s = e->add_child<folia::Sentence>( args );
+    append_to_sentence( s, sents[0] );
+    if  (options.debugFlag > 0){
+      DBG << "created a new sentence: " << s << endl;
+    }
+  }
+}
+
 void FrogAPI::handle_one_text_parent( ostream& os,
 				      folia::FoliaElement *e,
 				      int& sentence_done ){
@@ -2645,15 +3784,18 @@ void FrogAPI::handle_one_text_parent( ostream& os,
     text = replace_spaces( text );
     vector<Tokenizer::Token> toks = tokenizer->tokenize_line( text );
     if ( toks.size() > 0 ){
-      frog_data res = frog_sentence( toks, ++sentence_done );
-      if ( !options.noStdOut ){
-	show_results( os, res );
-      }
-      if ( options.doXMLout ){
-	vector<folia::Word*> wv;
-	wv.push_back( word );
-	append_to_words( wv, res );
-      }
+      dispatch_sentence( extract_fd( toks, false ),
+			 ++sentence_done,
+			 [this,&os,word]( frog_data& res ){
+			   if ( !options.noStdOut ){
+			     show_results( os, res );
+			   }
+			   if ( options.doXMLout ){
+			     vector<folia::Word*> wv;
+			     wv.push_back( word );
+			     append_to_words( wv, res );
+			   }
+			 } );
     }
   }
   else if ( e->xmltag() == "s" ){
@@ -2699,84 +3841,29 @@ void FrogAPI::handle_one_text_parent( ostream& os,
       timers.tokTimer.start();
       vector<Tokenizer::Token> toks = tokenizer->tokenize_line( text );
       timers.tokTimer.stop();
-      vector<frog_data*> sents; // a vector of pointers, to avoid premature
-      // deletion of the frog_data
+      vector<frog_data> parts;
       while ( toks.size() > 0 ){
-	frog_data *res = new frog_data( frog_sentence( toks, ++sentence_done) );
-	sents.push_back( res );
-	if ( !options.noStdOut ){
-	  show_results( os, *res );
-	}
+	parts.push_back( extract_fd( toks, false ) );
 	timers.tokTimer.start();
 	toks = tokenizer->tokenize_next( );
 	timers.tokTimer.stop();
       }
-      if ( options.doXMLout ){
-	if ( sents.size() == 0 ){
-	  // might happen in rare cases
-	  // just skip
-	}
-	else if ( sents.size() > 1 ){
-	  // multiple sentences. We need an extra Paragraph. when allowed
-	  if ( e->acceptable<folia::Paragraph>() ){
-	    folia::KWargs p_args;
-	    string e_id = e->id();
-	    if ( !e_id.empty() ){
-	      p_args["generate_id"] = e_id;
-	    }
-	    folia::Paragraph *p = e->add_child<folia::Paragraph>( p_args );
-	    for ( const auto& sent : sents ){
-	      folia::KWargs args;
-	      string p_id = p->id();
-	      if ( !p_id.empty() ){
-		args["generate_id"] = p_id;
-	      }
-	      folia::Sentence *s = p->add_child<folia::Sentence>( args );
-	      append_to_sentence( s, *sent );
-	      if  (options.debugFlag > 0){
-		DBG << "created a new sentence: " << s << endl;
-	      }
-	    }
-	  }
-	  else {
-	    if ( options.debugFlag > 5 ){
-	      DBG << "not e->acceptable\n" << e << endl;
-	    }
-	    for ( const auto& sent : sents ){
-	      folia::KWargs args;
-	      string e_id = e->id();
-	      if ( !e_id.empty() ){
-		args["generate_id"] = e_id;
-	      }
-	      folia::Sentence *s = e->add_child<folia::Sentence>( args );
-	      append_to_sentence( s, *sent );
-	      if  (options.debugFlag > 0){
-		DBG << "created a new sentence: " << s << endl;
-	      }
-	    }
-	  }
-	}
-	else {
-	  // 1 sentence, connect directly.
-	  folia::KWargs args;
-	  string e_id = e->id();
-	  if ( e_id.empty() ){
-	    e_id = e->generateId( e->xmltag() );
-	    args["xml:id"] = e_id + ".s.1";
-	  }
-	  else {
-	    args["generate_id"] = e_id;
-	  }
-	  folia::Sentence *s = e->add_child<folia::Sentence>( args );
-	  append_to_sentence( s, *sents[0] );
-	  if  (options.debugFlag > 0){
-	    DBG << "created a new sentence: " << s << endl;
-	  }
-	}
-      }
-      // now we are allowed to cleanup the frog_data
-      for ( const auto& s : sents ){
-	delete s;
+      // the frogged sentences are collected here. They can only be added to
+      // the FoLiA when the last one is delivered.
+      auto sents = make_shared<vector<frog_data>>( parts.size() );
+      for ( size_t i=0; i < parts.size(); ++i ){
+	dispatch_sentence( std::move(parts[i]),
+			   ++sentence_done,
+			   [this,&os,e,sents,i]( frog_data& res ){
+			     if ( !options.noStdOut ){
+			       show_results( os, res );
+			     }
+			     (*sents)[i] = std::move(res);
+			     if ( options.doXMLout
+				  && i+1 == sents->size() ){
+			       append_sentences( e, *sents );
+			     }
+			   } );
       }
     }
     else if ( !pv.empty() ){
@@ -2795,11 +3882,14 @@ void FrogAPI::handle_one_text_parent( ostream& os,
 }
 
 folia::Document *FrogAPI::run_folia_engine( const string& infilename,
-					    ostream& output_stream ){
+					    ostream& output_stream,
+					    bool from_buffer ){
   /// Run frog on a FoLiA XML file
   /*!
     \param infilename the name of the inputfile containing FoLiA
     \param output_stream the stream to output tabbed/JSON to.
+    \param from_buffer when true, infilename holds the FoLiA document itself,
+    (e.g. as received by the server) instead of a filename
     \return a Frogged FoLiA Document
 
     using folia::TextEngine, this function will loop through all relevant
@@ -2812,14 +3902,26 @@ folia::Document *FrogAPI::run_folia_engine( const string& infilename,
     tokenizer->setFiltering(false);
   }
   if ( options.debugFlag > 0 ){
-    DBG << "run_folia_engine(" << infilename << ")" << endl;
+    if ( from_buffer ){
+      DBG << "run_folia_engine(<buffer of " << infilename.size()
+	  << " bytes>)" << endl;
+    }
+    else {
+      DBG << "run_folia_engine(" << infilename << ")" << endl;
+    }
   }
   folia::TextEngine engine;
   if  (options.debugFlag > 8){
     engine.set_dbg_stream( theDbgLog );
     engine.set_debug( true );
   }
-  engine.init_doc( infilename );
+  if ( from_buffer ){
+    // parse straight from memory, no need for a temporary file
+    engine.init_from_string( infilename );
+  }
+  else {
+    engine.init_doc( infilename );
+  }
   engine.setup( options.inputclass, true );
   if ( engine.text_parent_count() == 0 ){
     LOG << "document contains no text in the desired inputclass: "
@@ -2840,14 +3942,22 @@ folia::Document *FrogAPI::run_folia_engine( const string& infilename,
     add_provenance( doc );
     int sentence_done = 0;
     folia::FoliaElement *p = 0;
-    while ( (p = engine.next_text_parent() ) ){
-      if ( options.debugFlag > 3 ){
-	DBG << "next text parent: " << p << endl;
-      }
-      handle_one_text_parent( output_stream, p, sentence_done );
-      if ( options.debugFlag > 0 ){
-	DBG << "done with sentence " << sentence_done << endl;
+    start_pipeline();
+    try {
+      while ( (p = engine.next_text_parent() ) ){
+	if ( options.debugFlag > 3 ){
+	  DBG << "next text parent: " << p << endl;
+	}
+	handle_one_text_parent( output_stream, p, sentence_done );
+	if ( options.debugFlag > 0 ){
+	  DBG << "done with sentence " << sentence_done << endl;
+	}
       }
+      finish_pipeline();
+    }
+    catch ( ... ){
+      stop_pipeline();
+      throw;
     }
     if ( sentence_done == 0 ){
       LOG << "Strange: didn't process any sentence...." << endl;
@@ -2890,20 +4000,34 @@ folia::Document *FrogAPI::run_text_engine( const string& infilename,
   timers.tokTimer.start();
   vector<Tokenizer::Token> toks = tokenizer->tokenize_stream( test_file );
   timers.tokTimer.stop();
-  while ( toks.size() > 0 ){
-    frog_data res = frog_sentence( toks, ++i );
-    if ( !options.noStdOut ){
-      show_results( os, res );
-    }
-    if ( options.doXMLout ){
-      root = append_to_folia( root, res, par_count );
-    }
-    if  (options.debugFlag > 0){
-      DBG << TiCC::Timer::now() << " done with sentence[" << i << "]" << endl;
+  start_pipeline();
+  try {
+    while ( toks.size() > 0 ){
+      ++i;
+      dispatch_sentence( extract_fd( toks, false ),
+			 i,
+			 [this,&os,&root,&par_count,i]( frog_data& res ){
+			   if ( !options.noStdOut ){
+			     show_results( os, res );
+			   }
+			   if ( options.doXMLout ){
+			     root = append_to_folia( root, res, par_count );
+			   }
+			   if  (options.debugFlag > 0){
+			     DBG << TiCC::Timer::now()
+				 << " done with sentence[" << i << "]" << endl;
+			   }
+			 } );
+      timers.tokTimer.start();
+      toks = tokenizer->tokenize_stream_next();
+      timers.tokTimer.stop();
     }
-    timers.tokTimer.start();
-    toks = tokenizer->tokenize_stream_next();
-    timers.tokTimer.stop();
+    finish_pipeline();
+  }
+  catch ( ... ){
+    stop_pipeline();
+    delete doc;
+    throw;
   }
   return doc;
 }
@@ -2928,45 +4052,71 @@ folia::Document *FrogAPI::FrogFile( const string& infilename ){
     xml_in = true;
   }
   timers.reset();
+  for ( const auto& ctx : contexts ){
+    ctx->timers.reset();
+  }
   if ( xml_in ){
     result = run_folia_engine( infilename, *outS );
   }
   else {
     result = run_text_engine( infilename, *outS );
   }
+  collect_timers();
   if ( !options.hide_timers ){
-    LOG << "tokenisation took:  " << timers.tokTimer << endl;
-    LOG << "CGN tagging took:   " << timers.tagTimer << endl;
-    if ( options.doIOB){
-      LOG << "IOB chunking took:  " << timers.iobTimer << endl;
-    }
-    if ( options.doNER){
-      LOG << "NER took:           " << timers.nerTimer << endl;
-    }
-    if ( options.doMbma ){
-      LOG << "MBMA took:          " << timers.mbmaTimer << endl;
-    }
-    if ( options.doLemma ){
-      LOG << "Mblem took:         " << timers.mblemTimer << endl;
+    wait_for_modules(); // for the cache statistics
+    if ( options.numWorkers > 1 ){
+      LOG << "timings are summed over " << options.numWorkers
+	  << " workers" << endl;
     }
-    if ( options.doMwu ){
-      LOG << "MWU resolving took: " << timers.mwuTimer << endl;
-    }
-    if ( options.doAlpino ){
-      LOG << "Parsing (prepare) took: " << timers.prepareTimer << endl;
-      LOG << "Parsing (total)   took: " << timers.parseTimer << endl;
+    show_timers( timers, true );
+  }
+  return result;
+}
+
+void FrogAPI::show_timers( const TimerBlock& tb, bool caches ) const {
+  /// log the time spent in every module
+  /*!
+    \param tb the timers to show
+    \param caches when true, also show the cache statistics of the modules
+   */
+  LOG << "tokenisation took:  " << tb.tokTimer << endl;
+  LOG << "CGN tagging took:   " << tb.tagTimer << endl;
+  if ( options.doIOB){
+    LOG << "IOB chunking took:  " << tb.iobTimer << endl;
+  }
+  if ( options.doNER){
+    LOG << "NER took:           " << tb.nerTimer << endl;
+  }
+  if ( options.doMbma ){
+    LOG << "MBMA took:          " << tb.mbmaTimer << endl;
+    string stats = caches ? myMbma->cache_stats() : "";
+    if ( !stats.empty() ){
+      LOG << "MBMA cache:         " << stats << endl;
     }
-    else if ( options.doParse ){
-      LOG << "Parsing (prepare) took: " << timers.prepareTimer << endl;
-      LOG << "Parsing (pairs)   took: " << timers.pairsTimer << endl;
-      LOG << "Parsing (rels)    took: " << timers.relsTimer << endl;
-      LOG << "Parsing (dir)     took: " << timers.dirTimer << endl;
-      LOG << "Parsing (csi)     took: " << timers.csiTimer << endl;
-      LOG << "Parsing (total)   took: " << timers.parseTimer << endl;
+  }
+  if ( options.doLemma ){
+    LOG << "Mblem took:         " << tb.mblemTimer << endl;
+    string stats = caches ? myMblem->cache_stats() : "";
+    if ( !stats.empty() ){
+      LOG << "Mblem cache:        " << stats << endl;
     }
-    LOG << "Frogging in total took: " << timers.frogTimer + timers.tokTimer << endl;
   }
-  return result;
+  if ( options.doMwu ){
+    LOG << "MWU resolving took: " << tb.mwuTimer << endl;
+  }
+  if ( options.doAlpino ){
+    LOG << "Parsing (prepare) took: " << tb.prepareTimer << endl;
+    LOG << "Parsing (total)   took: " << tb.parseTimer << endl;
+  }
+  else if ( options.doParse ){
+    LOG << "Parsing (prepare) took: " << tb.prepareTimer << endl;
+    LOG << "Parsing (pairs)   took: " << tb.pairsTimer << endl;
+    LOG << "Parsing (rels)    took: " << tb.relsTimer << endl;
+    LOG << "Parsing (dir)     took: " << tb.dirTimer << endl;
+    LOG << "Parsing (csi)     took: " << tb.csiTimer << endl;
+    LOG << "Parsing (total)   took: " << tb.parseTimer << endl;
+  }
+  LOG << "Frogging in total took: " << tb.frogTimer + tb.tokTimer << endl;
 }
 
 int folia_diff( const string& s1, const string& s2 ){
@@ -43,10 +43,10 @@
 #include "config.h"
 #include "ticcutils/Configuration.h"
 #include "ticcutils/PrettyPrint.h"
-#include "ticcutils/SocketBasics.h"
 #include "ticcutils/json.hpp"
 #include "timbl/TimblAPI.h"
 #include "frog/Frog-util.h"
+#include "frog/server_pool.h"
 #include "frog/csidp.h"
 #include "frog/Parser.h"
 
@@ -59,13 +59,73 @@ using namespace nlohmann;
 #define LOG *TiCC::Log(errLog)
 #define DBG *TiCC::Dbg(dbgLog)
 
-/// structure to store parsing results
-struct parseData {
-  void clear() { words.clear(); heads.clear(); mods.clear(); mwus.clear(); }
-  vector<UnicodeString> words;
-  vector<UnicodeString> heads;
-  vector<UnicodeString> mods;
-  vector<vector<folia::Word*> > mwus;
+// fixed feature values. empty_feature is also used outside the sentence
+static const UnicodeString empty_feature = "__";
+static const UnicodeString root_feature = "ROOT";
+static const UnicodeString left_feature = "LEFT";
+static const UnicodeString right_feature = "RIGHT";
+static const UnicodeString pair_class = "_";
+
+const UnicodeString& parseData::feature( const vector<UnicodeString>& v,
+					int i ){
+  /// the feature at position \e i, or "__" when \e i is outside the sentence
+  if ( i < 0 || i >= (int)v.size() ){
+    return empty_feature;
+  }
+  return v[i];
+}
+
+/// \brief assembles Timbl instances feature by feature
+/*!
+  Every instance is built in one buffer, big enough for the largest
+  instance seen so far, instead of by concatenating temporary strings.
+ */
+class instanceBuilder {
+ public:
+  instanceBuilder(): capacity(128), first(true){};
+  void start(){
+    /// start a new instance
+    inst = UnicodeString( capacity, 0, 0 );
+    first = true;
+  }
+  instanceBuilder& add( const UnicodeString& f ){
+    /// add feature \e f
+    separate();
+    inst.append( f );
+    return *this;
+  }
+  instanceBuilder& add( const UnicodeString& f1,
+			const UnicodeString& f2 ){
+    /// add the combined feature f1^f2
+    separate();
+    inst.append( f1 ).append( u'^' ).append( f2 );
+    return *this;
+  }
+  instanceBuilder& add( const UnicodeString& f1,
+			const UnicodeString& f2,
+			const UnicodeString& f3 ){
+    /// add the combined feature f1^f2^f3
+    separate();
+    inst.append( f1 ).append( u'^' ).append( f2 ).append( u'^' ).append( f3 );
+    return *this;
+  }
+  UnicodeString finish(){
+    /// return the instance, and remember its size for the next one
+    capacity = max( capacity, inst.length() + 16 );
+    return std::move( inst );
+  }
+ private:
+  void separate(){
+    if ( first ){
+      first = false;
+    }
+    else {
+      inst.append( u' ' );
+    }
+  }
+  UnicodeString inst;
+  int32_t capacity;
+  bool first;
 };
 
 ostream& operator<<( ostream& os, const parseData& pd ){
@@ -126,6 +186,7 @@ bool Parser::init( const TiCC::Configuration& configuration ){
     if ( TiCC::stringTo<int>( val, level ) ){
       if ( level > 5 ){
 	dbgLog->set_level( LogLevel::LogDebug );
+	debug = true;
       }
     }
   }
@@ -179,6 +240,30 @@ bool Parser::init( const TiCC::Configuration& configuration ){
       problem = true;
     }
   }
+  val = configuration.lookUp( "boundedDecodingMin", "parser" );
+  if ( !val.empty() ){
+    if ( !TiCC::stringTo<size_t>( val, boundedMin ) ){
+      LOG << "invalid boundedDecodingMin value in config file" << endl;
+      LOG << "keeping default " << boundedMin << endl;
+      problem = true;
+    }
+  }
+  val = configuration.lookUp( "threads", "parser" );
+  if ( !val.empty() ){
+    if ( !TiCC::stringTo<int>( val, numThreads ) || numThreads < 1 ){
+      LOG << "invalid threads value in config file" << endl;
+      numThreads = 1;
+      problem = true;
+    }
+  }
+  val = configuration.lookUp( "parallelDecodingMin", "parser" );
+  if ( !val.empty() ){
+    if ( !TiCC::stringTo<size_t>( val, parallelMin ) ){
+      LOG << "invalid parallelDecodingMin value in config file" << endl;
+      LOG << "keeping default " << parallelMin << endl;
+      problem = true;
+    }
+  }
 
   val = configuration.lookUp( "host", "parser" );
   if ( !val.empty() ){
@@ -325,10 +410,12 @@ Parser::~Parser(){
   delete pairs;
 }
 
-vector<UnicodeString> Parser::createPairInstances( const parseData& pd ){
+vector<UnicodeString> createPairInstances( const parseData& pd,
+					   size_t maxDepSpan ){
   /// create a list of Instances for the 'pairs' Timbl
   /*!
     \param pd the parsedata structure with words, heads and modifiers
+    \param maxDepSpan the maximum distance between the tokens of a pair
     \return a list of string where every string is a Timbl test instance
   */
   vector<UnicodeString> instances;
@@ -343,138 +430,67 @@ vector<UnicodeString> Parser::createPairInstances( const parseData& pd ){
     instances.push_back( inst );
   }
   else {
-    for ( size_t i=0 ; i < words.size(); ++i ){
-      UnicodeString word_1, word0, word1;
-      UnicodeString tag_1, tag0, tag1;
-      UnicodeString mods0;
-      if ( i == 0 ){
-	word_1 = "__";
-	tag_1 = "__";
-      }
-      else {
-	word_1 = words[i-1];
-	tag_1 = heads[i-1];
-      }
-      word0 = words[i];
-      tag0 = heads[i];
-      mods0 = mods[i];
-      if ( i == words.size() - 1 ){
-	word1 = "__";
-	tag1 = "__";
-      }
-      else {
-	word1 = words[i+1];
-	tag1 = heads[i+1];
-      }
-      UnicodeString inst = word_1 + " " + word0 + " " + word1
-	+ " ROOT ROOT ROOT " + tag_1 + " "
-	+ tag0 + " " + tag1 + " ROOT ROOT ROOT " + tag0
-	+ "^ROOT ROOT ROOT ROOT^" + mods0 + " _";
-      instances.push_back( inst );
+    // the windows of 3 words and 3 heads around every position are part
+    // of many instances, so build them only once
+    const int len = words.size();
+    instanceBuilder builder;
+    vector<UnicodeString> word_window( len );
+    vector<UnicodeString> head_window( len );
+    for ( int i=0; i < len; ++i ){
+      builder.start();
+      builder.add( pd.word(i-1) ).add( pd.word(i) ).add( pd.word(i+1) );
+      word_window[i] = builder.finish();
+      builder.start();
+      builder.add( pd.head(i-1) ).add( pd.head(i) ).add( pd.head(i+1) );
+      head_window[i] = builder.finish();
+    }
+    vector<UnicodeString> distances( min( words.size(), maxDepSpan + 1 ) );
+    for ( size_t d=1; d < distances.size(); ++d ){
+      distances[d] = TiCC::toUnicodeString( d );
+    }
+    for ( int i=0; i < len; ++i ){
+      builder.start();
+      builder.add( word_window[i] )
+	.add( root_feature ).add( root_feature ).add( root_feature )
+	.add( head_window[i] )
+	.add( root_feature ).add( root_feature ).add( root_feature )
+	.add( heads[i], root_feature )
+	.add( root_feature ).add( root_feature )
+	.add( root_feature, mods[i] )
+	.add( pair_class );
+      instances.push_back( builder.finish() );
     }
     //
-    for ( size_t wPos=0; wPos < words.size(); ++wPos ){
-      UnicodeString w_word_1, w_word0, w_word1;
-      UnicodeString w_tag_1, w_tag0, w_tag1;
-      UnicodeString w_mods0;
-      if ( wPos == 0 ){
-	w_word_1 = "__";
-	w_tag_1 = "__";
-      }
-      else {
-	w_word_1 = words[wPos-1];
-	w_tag_1 = heads[wPos-1];
-      }
-      w_word0 = words[wPos];
-      w_tag0 = heads[wPos];
-      w_mods0 = mods[wPos];
-      if ( wPos == words.size()-1 ){
-	w_word1 = "__";
-	w_tag1 = "__";
-      }
-      else {
-	w_word1 = words[wPos+1];
-	w_tag1 = heads[wPos+1];
-      }
-      for ( size_t pos=0; pos < words.size(); ++pos ){
-	if ( pos > wPos + maxDepSpan ){
-	  break;
-	}
+    const int span = maxDepSpan;
+    for ( int wPos=0; wPos < len; ++wPos ){
+      for ( int pos = max( 0, wPos - span );
+	    pos < len && pos <= wPos + span;
+	    ++pos ){
 	if ( pos == wPos ){
 	  continue;
 	}
-	if ( pos + maxDepSpan < wPos ){
-	  continue;
-	}
-	UnicodeString inst = w_word_1 + " " + w_word0 + " " + w_word1;
-
-	if ( pos == 0 ){
-	  inst += " __";
-	}
-	else {
-	  inst += " " + words[pos-1];
-	}
-	if ( pos < words.size() ){
-	  inst += " " + words[pos];
-	}
-	else {
-	  inst += " __";
-	}
-	if ( pos < words.size()-1 ){
-	  inst += " " + words[pos+1];
-	}
-	else {
-	  inst += " __";
-	}
-	inst += " " + w_tag_1 + " " + w_tag0 + " " + w_tag1;
-	if ( pos == 0 ){
-	  inst += " __";
-	}
-	else {
-	  inst += " " + heads[pos-1];
-	}
-	if ( pos < words.size() ){
-	  inst += " " + heads[pos];
-	}
-	else {
-	  inst += " __";
-	}
-	if ( pos < words.size()-1 ){
-	  inst += " " + heads[pos+1];
-	}
-	else {
-	  inst += " __";
-	}
-
-	inst += " " + w_tag0 + "^";
-	if ( pos < words.size() ){
-	  inst += heads[pos];
-	}
-	else {
-	  inst += "__";
-	}
-
+	builder.start();
+	builder.add( word_window[wPos] )
+	  .add( word_window[pos] )
+	  .add( head_window[wPos] )
+	  .add( head_window[pos] )
+	  .add( heads[wPos], heads[pos] );
 	if ( wPos > pos ){
-	  inst += " LEFT " + TiCC::toUnicodeString( wPos - pos );
-	}
-	else {
-	  inst += " RIGHT "+ TiCC::toUnicodeString( pos - wPos );
-	}
-	if ( pos >= words.size() ){
-	  inst += " __";
+	  builder.add( left_feature ).add( distances[wPos - pos] );
 	}
 	else {
-	  inst += " " + mods[pos];
+	  builder.add( right_feature ).add( distances[pos - wPos] );
 	}
-	inst += "^" + w_mods0 + " __";
-	instances.push_back( inst );
+	builder.add( mods[pos], mods[wPos] )
+	  .add( empty_feature );
+	instances.push_back( builder.finish() );
       }
     }
   }
   return instances;
 }
 
-vector<UnicodeString> Parser::createDirInstances( const parseData& pd ){
+vector<UnicodeString> createDirInstances( const parseData& pd ){
   /// create a list of Instances for the 'dir' Timbl
   /*!
     \param pd the parsedata structure with words, heads and modifiers
@@ -606,92 +622,31 @@ vector<UnicodeString> Parser::createDirInstances( const parseData& pd ){
     d_instances.push_back( inst );
   }
   else {
-    for ( size_t i=0 ; i < words.size(); ++i ){
-      UnicodeString word_1, word_2;
-      UnicodeString tag_1, tag_2;
-      UnicodeString mod_1;
-      if ( i == 0 ){
-	word_2 = "__";
-	tag_2 = "__";
-	//	mod_2 = "__";
-	word_1 = "__";
-	tag_1 = "__";
-	mod_1 = "__";
+    instanceBuilder builder;
+    for ( int i=0 ; i < (int)words.size(); ++i ){
+      builder.start();
+      for ( int j=i-2; j <= i+2; ++j ){
+	builder.add( pd.word(j) );
       }
-      else if ( i == 1 ){
-	word_2 = "__";
-	tag_2 = "__";
-	//	mod_2 = "__";
-	word_1 = words[i-1];
-	tag_1 = heads[i-1];
-	mod_1 = mods[i-1];
+      for ( int j=i-2; j <= i+2; ++j ){
+	builder.add( pd.head(j) );
       }
-      else {
-	word_2 = words[i-2];
-	tag_2 = heads[i-2];
-	//	mod_2 = mods[i-2];
-	word_1 = words[i-1];
-	tag_1 = heads[i-1];
-	mod_1 = mods[i-1];
-      }
-      UnicodeString word0 = words[i];
-      UnicodeString word1, word2;
-      UnicodeString tag0 = heads[i];
-      UnicodeString tag1, tag2;
-      UnicodeString mod0 = mods[i];
-      UnicodeString mod1;
-      if ( i < words.size() - 2 ){
-	word1 = words[i+1];
-	tag1 = heads[i+1];
-	mod1 = mods[i+1];
-	word2 = words[i+2];
-	tag2 = heads[i+2];
-	//	mod2 = mods[i+2];
-      }
-      else if ( i == words.size() - 2 ){
-	word1 = words[i+1];
-	tag1 = heads[i+1];
-	mod1 = mods[i+1];
-	word2 = "__";
-	tag2 = "__";
-	//	mod2 = "__";
+      for ( int j=i-2; j <= i+2; ++j ){
+	builder.add( pd.word(j), pd.head(j) );
       }
-      else {
-	word1 = "__";
-	tag1 = "__";
-	mod1 = "__";
-	word2 = "__";
-	tag2 = "__";
-	//	mod2 = "__";
-      }
-      UnicodeString inst = word_2
-	+ " " + word_1
-	+ " " + word0
-	+ " " + word1
-	+ " " + word2
-	+ " " + tag_2
-	+ " " + tag_1
-	+ " " + tag0
-	+ " " + tag1
-	+ " " + tag2
-	+ " " + word_2 + "^" + tag_2
-	+ " " + word_1 + "^" + tag_1
-	+ " " + word0 + "^" + tag0
-	+ " " + word1 + "^" + tag1
-	+ " " + word2 + "^" + tag2
-	+ " " + tag_1 + "^" + tag0
-	+ " " + tag0 + "^" + tag1
-	+ " " + mod_1
-	+ " " + mod0
-	+ " " + mod1
-	+ " ROOT";
-      d_instances.push_back( inst );
+      builder.add( pd.head(i-1), pd.head(i) )
+	.add( pd.head(i), pd.head(i+1) )
+	.add( pd.mod(i-1) )
+	.add( pd.mod(i) )
+	.add( pd.mod(i+1) )
+	.add( root_feature );
+      d_instances.push_back( builder.finish() );
     }
   }
   return d_instances;
 }
 
-vector<UnicodeString> Parser::createRelInstances( const parseData& pd ){
+vector<UnicodeString> createRelInstances( const parseData& pd ){
   /// create a list of Instances for the 'rel' Timbl
   /*!
     \param pd the parsedata structure with words, heads and modifiers
@@ -811,68 +766,22 @@ vector<UnicodeString> Parser::createRelInstances( const parseData& pd ){
     r_instances.push_back( inst );
   }
   else {
-    for ( size_t i=0 ; i < words.size(); ++i ){
-      UnicodeString word_1, word_2;
-      UnicodeString tag_1, tag_2;
-      if ( i == 0 ){
-	word_2 = "__";
-	tag_2 = "__";
-	word_1 = "__";
-	tag_1 = "__";
-      }
-      else if ( i == 1 ){
-	word_2 = "__";
-	tag_2 = "__";
-	word_1 = words[i-1];
-	tag_1 = heads[i-1];
+    instanceBuilder builder;
+    for ( int i=0 ; i < (int)words.size(); ++i ){
+      builder.start();
+      for ( int j=i-2; j <= i+2; ++j ){
+	builder.add( pd.word(j) );
       }
-      else {
-	word_2 = words[i-2];
-	tag_2 = heads[i-2];
-	word_1 = words[i-1];
-	tag_1 = heads[i-1];
-      }
-      UnicodeString word0 = words[i];
-      UnicodeString word1, word2;
-      UnicodeString tag0 = heads[i];
-      UnicodeString tag1, tag2;
-      UnicodeString mod0 = mods[i];
-      if ( i < words.size() - 2 ){
-	word1 = words[i+1];
-	tag1 = heads[i+1];
-	word2 = words[i+2];
-	tag2 = heads[i+2];
-      }
-      else if ( i == words.size() - 2 ){
-	word1 = words[i+1];
-	tag1 = heads[i+1];
-	word2 = "__";
-	tag2 = "__";
+      builder.add( pd.mod(i) );
+      for ( int j=i-2; j <= i+2; ++j ){
+	builder.add( pd.head(j) );
       }
-      else {
-	word1 = "__";
-	tag1 = "__";
-	word2 = "__";
-	tag2 = "__";
-      }
-      //
-      UnicodeString inst = word_2
-	+ " " + word_1
-	+ " " + word0
-	+ " " + word1
-	+ " " + word2
-	+ " " + mod0
-	+ " " + tag_2
-	+ " " + tag_1
-	+ " " + tag0
-	+ " " + tag1
-	+ " " + tag2
-	+ " " + tag_1 + "^" + tag0
-	+ " " + tag0 + "^" + tag1
-	+ " " + tag_2 + "^" + tag_1 + "^" + tag0
-	+ " " + tag0 + "^" + tag1 + "^" + tag2
-	+ " __";
-      r_instances.push_back( inst );
+      builder.add( pd.head(i-1), pd.head(i) )
+	.add( pd.head(i), pd.head(i+1) )
+	.add( pd.head(i-2), pd.head(i-1), pd.head(i) )
+	.add( pd.head(i), pd.head(i+1), pd.head(i+2) )
+	.add( empty_feature );
+      r_instances.push_back( builder.finish() );
     }
   }
   return r_instances;
@@ -1030,44 +939,7 @@ vector<timbl_result> Parser::timbl_server( const string& base,
     all instances
    */
   vector<timbl_result> result;
-  Sockets::ClientSocket client;
-  if ( !client.connect( _host, _port ) ){
-    LOG << "failed to open connection, " << _host
-	<< ":" << _port << endl
-	<< "Reason: " << client.getMessage() << endl;
-    exit( EXIT_FAILURE );
-  }
   DBG << "calling " << base << " server" << endl;
-  string line;
-  client.read( line );
-  json response;
-  try {
-    response = json::parse( line );
-  }
-  catch ( const exception& e ){
-    LOG << "json parsing failed on '" << line << "':"
-	<< e.what() << endl;
-    abort();
-  }
-  DBG << "received json data:" << response.dump(2) << endl;
-
-  json out_json;
-  out_json["command"] = "base";
-  out_json["param"] = base;
-  string out_line = out_json.dump() + "\n";
-  DBG << "sending BASE json data:" << out_line << endl;
-  client.write( out_line );
-  client.read( line );
-  try {
-    response = json::parse( line );
-  }
-  catch ( const exception& e ){
-    LOG << "json parsing failed on '" << line << "':"
-	<< e.what() << endl;
-    abort();
-  }
-  DBG << "received json data:" << response.dump(2) << endl;
-
   // create json query struct
   json query;
   query["command"] = "classify";
@@ -1077,21 +949,7 @@ vector<timbl_result> Parser::timbl_server( const string& base,
   }
   query["params"] = arr;
   DBG << "send json" << query.dump(2) << endl;
-  // send it to the server
-  line = query.dump() + "\n";
-  client.write( line );
-  // receive json
-  client.read( line );
-  DBG << "received line:" << line << "" << endl;
-  try {
-    response = json::parse( line );
-  }
-  catch ( const exception& e ){
-    LOG << "json parsing failed on '" << line << "':"
-	<< e.what() << endl;
-    LOG << "the request to the server was: '" <<  query.dump(2) << "'" << endl;
-    abort();
-  }
+  json response = ServerPool::get( _host, _port, base )->call( query );
   DBG << "received json data:" << response.dump(2) << endl;
   if ( !response.is_array() ){
     string cat = response["category"];
@@ -1164,7 +1022,7 @@ void Parser::Parse( frog_data& fd, TimerBlock& timers ){
 #pragma omp section
       {
 	timers.pairsTimer.start();
-	vector<UnicodeString> instances = createPairInstances( pd );
+	vector<UnicodeString> instances = createPairInstances( pd, maxDepSpan );
 	if ( _host.empty() ){
 	  p_results = timbl( pairs, instances );
 	}
@@ -1200,12 +1058,19 @@ void Parser::Parse( frog_data& fd, TimerBlock& timers ){
   }
 
   timers.csiTimer.start();
+  cky_options opts;
+  opts.bounded = boundedMin > 0 && pd.words.size() >= boundedMin;
+  if ( parallelMin > 0 && pd.words.size() >= parallelMin ){
+    opts.threads = numThreads;
+  }
+  opts.debug = debug;
   vector<parsrel> res = parse( p_results,
 			       r_results,
 			       d_results,
 			       pd.words.size(),
 			       maxDepSpan,
-			       dbgLog );
+			       dbgLog,
+			       opts );
   timers.csiTimer.stop();
   appendParseResult( fd, res );
   timers.parseTimer.stop();
@@ -0,0 +1,343 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#include "frog/alpino_pool.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <chrono>
+#include <stdexcept>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "ticcutils/StringOps.h"
+
+using namespace std;
+
+AlpinoWorker::AlpinoWorker( const vector<string>& cmd ):
+  command( cmd ),
+  pid( 0 ),
+  sock( -1 ),
+  counter( 0 )
+{
+}
+
+AlpinoWorker::~AlpinoWorker(){
+  stop();
+}
+
+bool AlpinoWorker::start( string& message ){
+  /// start the Alpino process
+  /*!
+    \param message an error message on failure
+    \return true on succes
+
+    The standard input and output of the process are connected to one end
+    of a socketpair, so we can write to it without risking a SIGPIPE when
+    the process dies. Standard error is discarded.
+  */
+  int sv[2];
+  if ( socketpair( AF_UNIX, SOCK_STREAM, 0, sv ) != 0 ){
+    message = string("socketpair failed: ") + strerror(errno);
+    return false;
+  }
+  // never leak our end into other children
+  fcntl( sv[0], F_SETFD, FD_CLOEXEC );
+  fcntl( sv[1], F_SETFD, FD_CLOEXEC );
+  // prepare everything before fork(). Only the bare minimum in the child
+  vector<char*> argv;
+  for ( const auto& arg : command ){
+    argv.push_back( const_cast<char*>( arg.c_str() ) );
+  }
+  argv.push_back( 0 );
+  pid_t child = fork();
+  if ( child < 0 ){
+    message = string("fork failed: ") + strerror(errno);
+    close( sv[0] );
+    close( sv[1] );
+    return false;
+  }
+  if ( child == 0 ){
+    int null_fd = open( "/dev/null", O_WRONLY );
+    dup2( sv[1], 0 );
+    dup2( sv[1], 1 );
+    if ( null_fd >= 0 ){
+      dup2( null_fd, 2 );
+    }
+    execvp( argv[0], argv.data() );
+    _exit( 127 );
+  }
+  close( sv[1] );
+  sock = sv[0];
+  pid = child;
+  buffer.clear();
+  return true;
+}
+
+void AlpinoWorker::stop(){
+  /// stop the Alpino process
+  if ( sock >= 0 ){
+    close( sock );
+    sock = -1;
+  }
+  if ( pid > 0 ){
+    kill( pid, SIGKILL );
+    waitpid( pid, 0, 0 );
+    pid = 0;
+  }
+}
+
+void AlpinoWorker::abandon(){
+  /// forget about the process, without stopping it.
+  /*!
+    Used in a forked child: the process belongs to our parent.
+  */
+  if ( sock >= 0 ){
+    close( sock );
+    sock = -1;
+  }
+  pid = 0;
+}
+
+bool AlpinoWorker::read_line( string& line,
+			      const chrono::steady_clock::time_point& deadline ){
+  /// read one line of output
+  /*!
+    \param line the line read, without the newline
+    \param deadline when to give up. time_point::max() means never
+    \return false on EOF, error or timeout
+  */
+  while ( true ){
+    string::size_type pos = buffer.find( '\n' );
+    if ( pos != string::npos ){
+      line = buffer.substr( 0, pos );
+      buffer.erase( 0, pos + 1 );
+      return true;
+    }
+    int wait = -1;
+    if ( deadline != chrono::steady_clock::time_point::max() ){
+      auto left = chrono::duration_cast<chrono::milliseconds>
+	( deadline - chrono::steady_clock::now() );
+      if ( left.count() <= 0 ){
+	return false;
+      }
+      wait = left.count();
+    }
+    struct pollfd pfd;
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    int res = poll( &pfd, 1, wait );
+    if ( res < 0 && errno == EINTR ){
+      continue;
+    }
+    if ( res <= 0 ){
+      return false;
+    }
+    char buf[4096];
+    ssize_t len = read( sock, buf, sizeof(buf) );
+    if ( len < 0 && errno == EINTR ){
+      continue;
+    }
+    if ( len <= 0 ){
+      return false;
+    }
+    buffer.append( buf, len );
+  }
+}
+
+bool AlpinoWorker::parse( const string& sentence,
+			  int timeout,
+			  string& xml ){
+  /// let the Alpino process parse one sentence
+  /*!
+    \param sentence the (tokenized) sentence
+    \param timeout the maximum time to wait for the result, in seconds.
+    0 means forever
+    \param xml the resulting Alpino XML document
+    \return false when the process failed. It should not be used anymore
+
+    Any output before the start of the XML document is skipped.
+  */
+  if ( sock < 0 ){
+    return false;
+  }
+  auto deadline = chrono::steady_clock::time_point::max();
+  if ( timeout > 0 ){
+    deadline = chrono::steady_clock::now() + chrono::seconds( timeout );
+  }
+  // Alpino uses the part before the '|' as the key of the sentence
+  string line = TiCC::toString( ++counter ) + "|" + sentence + "\n";
+  const char *data = line.c_str();
+  size_t todo = line.size();
+  while ( todo > 0 ){
+    ssize_t len = send( sock, data, todo, MSG_NOSIGNAL );
+    if ( len < 0 ){
+      if ( errno == EINTR ){
+	continue;
+      }
+      return false;
+    }
+    data += len;
+    todo -= len;
+  }
+  xml.clear();
+  bool in_document = false;
+  string out;
+  while ( read_line( out, deadline ) ){
+    if ( !in_document ){
+      string::size_type pos = out.find( "<?xml" );
+      if ( pos == string::npos ){
+	pos = out.find( "<alpino_ds" );
+      }
+      if ( pos == string::npos ){
+	continue; // noise
+      }
+      out.erase( 0, pos );
+      in_document = true;
+    }
+    xml += out + "\n";
+    if ( out.find( "</alpino_ds>" ) != string::npos ){
+      return true;
+    }
+  }
+  return false;
+}
+
+AlpinoPool::AlpinoPool( const string& cmd,
+			size_t max_workers,
+			int timeout ):
+  _max_workers( max_workers ),
+  _timeout( timeout ),
+  busy( 0 ),
+  _restarts( 0 ),
+  owner( getpid() )
+{
+  /// create a pool of Alpino processes. No process is started yet
+  /*!
+    \param cmd the command to start one process, including its options
+    \param max_workers the maximum number of processes running at the same
+    time
+    \param timeout the maximum time to parse one sentence, in seconds.
+    0 means no limit
+  */
+  command = TiCC::split( cmd );
+  if ( command.empty() ){
+    throw invalid_argument( "AlpinoPool: empty command" );
+  }
+  if ( _max_workers == 0 ){
+    _max_workers = 1;
+  }
+}
+
+AlpinoPool::~AlpinoPool(){
+  lock_guard<mutex> guard( pool_lock );
+  if ( owner != getpid() ){
+    for ( auto& w : idle ){
+      w->abandon();
+    }
+  }
+  idle.clear();
+}
+
+unique_ptr<AlpinoWorker> AlpinoPool::acquire(){
+  /// take an idle worker, or a new one. Waits when all workers are busy
+  unique_lock<mutex> guard( pool_lock );
+  if ( owner != getpid() ){
+    // we are a forked child. The processes belong to our parent
+    for ( auto& w : idle ){
+      w->abandon();
+    }
+    idle.clear();
+    busy = 0;
+    owner = getpid();
+  }
+  pool_cv.wait( guard, [this]{ return busy < _max_workers; } );
+  ++busy;
+  if ( !idle.empty() ){
+    unique_ptr<AlpinoWorker> result = std::move( idle.back() );
+    idle.pop_back();
+    return result;
+  }
+  return unique_ptr<AlpinoWorker>( new AlpinoWorker( command ) );
+}
+
+void AlpinoPool::release( unique_ptr<AlpinoWorker> worker, bool failed ){
+  /// hand back a worker. A failed worker is stopped.
+  {
+    lock_guard<mutex> guard( pool_lock );
+    if ( failed ){
+      worker->stop();
+      ++_restarts;
+    }
+    else {
+      idle.push_back( std::move( worker ) );
+    }
+    --busy;
+  }
+  pool_cv.notify_one();
+}
+
+string AlpinoPool::parse( const string& sentence ){
+  /// parse one sentence, using one of the workers
+  /*!
+    \param sentence the (tokenized) sentence
+    \return an Alpino XML document, or "" on failure
+
+    When a worker dies while parsing, we give the sentence a second chance
+    on a fresh worker. A worker that hangs longer than the timeout is
+    stopped, and the sentence is not retried.
+  */
+  for ( int attempt = 0; attempt < 2; ++attempt ){
+    unique_ptr<AlpinoWorker> worker = acquire();
+    if ( !worker->running() ){
+      string message;
+      if ( !worker->start( message ) ){
+	release( std::move( worker ), true );
+	throw runtime_error( "unable to start Alpino: " + message );
+      }
+    }
+    string xml;
+    time_t start = time(0);
+    if ( worker->parse( sentence, _timeout, xml ) ){
+      release( std::move( worker ), false );
+      return xml;
+    }
+    release( std::move( worker ), true );
+    if ( _timeout > 0 && time(0) - start >= _timeout ){
+      break;
+    }
+  }
+  return "";
+}
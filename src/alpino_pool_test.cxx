@@ -0,0 +1,152 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+// test the AlpinoPool, using tests/alpino_stub.sh as a stand-in for Alpino
+
+#include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include "ticcutils/LogStream.h"
+#include "frog/alpino_pool.h"
+#include "frog/AlpinoParser.h"
+
+using namespace std;
+
+static int failures = 0;
+
+static void check( bool ok, const string& what ){
+  cout << ( ok ? "ok:     " : "FAILED: " ) << what << endl;
+  if ( !ok ){
+    ++failures;
+  }
+}
+
+static void test_concurrent( const string& stub ){
+  /// 4 threads share a pool of 2 workers, like the Frog workers do
+  string log_name = string(P_tmpdir) + "/alpino_pool_test."
+    + to_string( getpid() ) + ".log";
+  setenv( "ALPINO_STUB_LOG", log_name.c_str(), 1 );
+  vector<string> results( 4 );
+  auto start = chrono::steady_clock::now();
+  {
+    AlpinoPool pool( "/bin/sh " + stub, 2, 10 );
+    vector<thread> callers;
+    for ( size_t i=0; i < results.size(); ++i ){
+      callers.push_back( thread( [&pool,&results,i]{
+	    results[i] = pool.parse( "SLOW zin " + to_string( i ) + " ." );
+	  } ) );
+    }
+    for ( auto& t : callers ){
+      t.join();
+    }
+    check( pool.restarts() == 0, "no restarts with concurrent callers" );
+  }
+  double secs = chrono::duration<double>( chrono::steady_clock::now()
+					  - start ).count();
+  unsetenv( "ALPINO_STUB_LOG" );
+  for ( size_t i=0; i < results.size(); ++i ){
+    string expect = "<sentence>SLOW zin " + to_string( i ) + " .</sentence>";
+    check( results[i].find( expect ) != string::npos,
+	   "concurrent caller " + to_string( i ) + " gets its own sentence" );
+  }
+  // every SLOW sentence takes a second: 4 of them on 2 workers take 2
+  check( secs >= 2 && secs < 3.5, "2 workers parse at the same time, the "
+	 "other callers wait (took " + to_string( secs ) + "s)" );
+  set<string> pids;
+  int active = 0;
+  int max_active = 0;
+  ifstream is( log_name );
+  string what;
+  string pid;
+  while ( is >> what >> pid ){
+    if ( what == "start" ){
+      pids.insert( pid );
+    }
+    else if ( what == "busy" ){
+      max_active = max( max_active, ++active );
+    }
+    else if ( what == "idle" ){
+      --active;
+    }
+  }
+  remove( log_name.c_str() );
+  check( pids.size() == 2, "exactly 2 Alpino processes are started (got "
+	 + to_string( pids.size() ) + ")" );
+  check( max_active == 2, "at most 2 sentences are parsed at the same "
+	 "time (got " + to_string( max_active ) + ")" );
+}
+
+int main(){
+  const char *srcdir = getenv( "srcdir" );
+  string stub = string( srcdir ? srcdir : "." ) + "/../tests/alpino_stub.sh";
+  TiCC::LogStream log( cerr );
+  AlpinoParser parser( &log, &log );
+  check( parser.thread_safe(), "the Pipeline may call the AlpinoParser from "
+	 "several threads at once" );
+  test_concurrent( stub );
+
+  AlpinoPool pool( "/bin/sh " + stub, 1, 2 );
+
+  string xml = pool.parse( "Dit is een zin ." );
+  check( xml.find( "<?xml" ) == 0, "noise before the document is skipped" );
+  check( xml.find( "<sentence>Dit is een zin .</sentence>" )
+	 != string::npos, "the sentence is parsed" );
+  check( pool.restarts() == 0, "no restarts for a normal sentence" );
+
+  xml = pool.parse( "CRASH" );
+  check( xml.empty(), "a crashing sentence gives no result" );
+  check( pool.restarts() == 2, "the crashed worker is replaced, and the "
+	 "sentence is retried once" );
+  xml = pool.parse( "Nog een zin ." );
+  check( xml.find( "<sentence>Nog een zin .</sentence>" ) != string::npos,
+	 "a new worker takes over after a crash" );
+
+  auto start = chrono::steady_clock::now();
+  xml = pool.parse( "HANG" );
+  double secs = chrono::duration<double>( chrono::steady_clock::now()
+					  - start ).count();
+  check( xml.empty(), "a hanging sentence gives no result" );
+  check( secs >= 1.5 && secs < 5, "the timeout covers the whole sentence, "
+	 "even when output trickles in (took "
+	 + to_string( secs ) + "s)" );
+  xml = pool.parse( "Een laatste zin ." );
+  check( xml.find( "<sentence>Een laatste zin .</sentence>" )
+	 != string::npos, "a new worker takes over after a timeout" );
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -228,17 +228,19 @@ string CGNTagger::getSubSet( const string& val,
 			   "' within the constraints for '" + head + "', full class is: '" + fullclass + "'" );
 }
 
-void CGNTagger::post_process( frog_data& words ){
+void CGNTagger::post_process( frog_data& words,
+			      const vector<TagResult>& tag_result ){
   /// add the found tagging results to the frog_data structure
   /*!
     \param words The frog_data structure to extend
+    \param tag_result the results of the MBT tagger
   */
-  for ( size_t i=0; i < _tag_result.size(); ++i ){
+  for ( size_t i=0; i < tag_result.size(); ++i ){
     addTag( words.units[i],
-	    _tag_result[i].assigned_tag(),
-	    _tag_result[i].confidence() );
-    if ( i < _tag_result.size()-1 ){
-      words.units[i].next_tag = _tag_result[i+1].assigned_tag();
+	    tag_result[i].assigned_tag(),
+	    tag_result[i].confidence() );
+    if ( i < tag_result.size()-1 ){
+      words.units[i].next_tag = tag_result[i+1].assigned_tag();
     }
   }
 }
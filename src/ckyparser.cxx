@@ -32,10 +32,13 @@
 #include "frog/ckyparser.h"
 
 #include <iostream>
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <sstream>
 #include <utility>
 #include <stdexcept>
+#include <exception>
 
 #include "ticcutils/PrettyPrint.h"
 #include "ticcutils/LogStream.h"
@@ -45,89 +48,183 @@ using namespace std;
 #define LOG *TiCC::Log(ckyLog)
 #define DBG *TiCC::Dbg(ckyLog)
 
-ostream& operator<<( ostream& os, const Constraint* c ){
-  /// output a Constraint (debug only)
-  if ( c ){
-    c->put( os );
-  }
+using TiCC::operator<<;
+
+static dirType toDirection( const string& s ){
+  /// convert a string into a dirType
+  if ( s == "ROOT" )
+    return ROOT;
+  else if ( s == "LEFT" )
+    return LEFT;
+  else if ( s == "RIGHT" )
+    return RIGHT;
   else {
-    os << "None";
+    abort();
   }
-  return os;
 }
 
-ostream& operator<<( ostream& os, const Constraint& c ){
-  /// output a Constraint (debug only)
-  return os << &c;
+ConstraintStore::ConstraintStore( size_t expected ){
+  /// create an empty store
+  /*!
+    \param expected the number of constraints to reserve space for
+   */
+  constraints.reserve( expected );
+  // the order must match fixed_label
+  for ( const auto& label : { "None", "ROOT", "__", "" } ){
+    intern( label );
+  }
 }
 
-using TiCC::operator<<;
+int ConstraintStore::intern( const string& rel ){
+  /// return the id of a relation, adding it when it is new
+  auto it = relation_ids.find( rel );
+  if ( it != relation_ids.end() ){
+    return it->second;
+  }
+  int id = relation_names.size();
+  relation_names.push_back( rel );
+  relation_ids[rel] = id;
+  return id;
+}
 
-void HasIncomingRel::put( ostream& os ) const {
-  /// output a HasIncomingRel (debug only)
-  Constraint::put( os );
-  os << " incoming rel=" << relType;
+void ConstraintStore::add_dependency( int token,
+				      int head,
+				      const string& rel,
+				      double weight ){
+  /// add a constraint that \e token depends on \e head with relation \e rel
+  wcsp_constraint c = { weight, token, head, intern( rel ),
+			wcsp_constraint::Dependency, ERROR };
+  constraints.push_back( c );
 }
 
+void ConstraintStore::add_incoming( int token,
+				    const string& rel,
+				    double weight ){
+  /// add a constraint that \e token has a dependent with relation \e rel
+  wcsp_constraint c = { weight, token, -1, intern( rel ),
+			wcsp_constraint::Incoming, ERROR };
+  constraints.push_back( c );
+}
 
-void HasDependency::put( ostream& os ) const {
-  /// output a HasDependency (debug only)
-  Constraint::put( os );
-  os << " dependency rel=" << relType << " head=" << headType;
+void ConstraintStore::add_direction( int token,
+				     const string& dir,
+				     double weight ){
+  /// add a constraint that the head of \e token is in direction \e dir
+  wcsp_constraint c = { weight, token, -1, NONE_LABEL,
+			wcsp_constraint::Direction, toDirection( dir ) };
+  constraints.push_back( c );
 }
 
-void DependencyDirection::put( ostream & os ) const {
-  /// output a DependencyDirection (debug only)
-  Constraint::put( os );
-  os << " direction=" << " " << direction;
+string ConstraintStore::to_string( const wcsp_constraint& c ) const {
+  /// give a readable representation of a constraint (debug only)
+  stringstream ss;
+  ss << c.token << " " << c.weight;
+  switch ( c.type ){
+  case wcsp_constraint::Incoming:
+    ss << " incoming rel=" << relation( c.rel );
+    break;
+  case wcsp_constraint::Dependency:
+    ss << " dependency rel=" << relation( c.rel ) << " head=" << c.head;
+    break;
+  case wcsp_constraint::Direction:
+    ss << " direction= "
+       << ( c.direction == ROOT ? "ROOT"
+	    : ( c.direction == LEFT ? "LEFT" : "RIGHT" ) );
+    break;
+  }
+  return ss.str();
 }
 
+ostream& operator<<( ostream& os, const ConstraintStore& store ){
+  /// output all constraints (debug only)
+  os << "[";
+  for ( const auto& c : store ){
+    os << store.to_string( c ) << ",";
+  }
+  os << "]";
+  return os;
+}
 
 CKYParser::CKYParser( size_t num,
-		      const vector<const Constraint*>& constraints,
-		      const TiCC::LogStream* log ):
-  numTokens(num)
+		      const ConstraintStore& constraints,
+		      const TiCC::LogStream* log,
+		      size_t span,
+		      bool dbg ):
+  numTokens(num),
+  maxSpan(span),
+  edgeWidth(0),
+  numWords(0),
+  store(constraints),
+  debug(dbg)
 {
   /// initalialize a CKYparser
   /*!
     \param num The number of tokens to parse
-    \param constraints A Constraints vector
+    \param constraints the constraints of the sentence. They should live as
+    long as the parser
     \param log a LogStream for (debug) messages.
+    \param span when > 0, only consider edges between tokens that are at
+    most \e span tokens apart, except for edges from the root.
+    \param dbg when true, log every step of the parse. This is costly,
+    even when the messages are discarded later.
    */
+  ckyLog = new TiCC::LogStream( log );
+  ckyLog->add_message( "cky:" );
+  for ( const auto& constraint : constraints ){
+    if ( constraint.type == wcsp_constraint::Dependency
+	 && constraint.head > 0 ){
+      size_t dist = abs( constraint.token - constraint.head );
+      edgeWidth = max( edgeWidth, dist );
+    }
+  }
   inDepConstraints.resize( numTokens + 1 );  // 1 dimensional array
   outDepConstraints.resize( numTokens + 1 ); // 1 dimensional array
-  edgeConstraints.resize( numTokens + 1 );   // 2 dimensional array
-  for ( auto& it : edgeConstraints ){
-    it.resize( numTokens + 1 ); // second dimension
-  }
-  chart.resize( numTokens +1 ); // 2 dimensional array
-  for ( auto& it : chart ){
-    it.resize( numTokens + 1 ); // second dimension
-  }
+  rootConstraints.resize( numTokens + 1 );   // 1 dimensional array
+  // a band of a 2 dimensional array, edgeWidth wide on both sides
+  edgeConstraints.resize( (numTokens + 1) * (2 * edgeWidth + 1) );
   for ( const auto& constraint : constraints ){
     addConstraint( constraint );
   }
-  ckyLog = new TiCC::LogStream( log );
-  ckyLog->add_message( "cky:" );
+  // The satisfied set of a SubTree is only searched for the incoming
+  // constraints of its head (s for the r_ SubTrees, t for the l_ ones), and
+  // no other constraints of that head can ever be in it. So we only keep
+  // those, numbered per token
+  size_t most = 0;
+  for ( auto& token_constraints : inDepConstraints ){
+    int bit = 0;
+    for ( auto& constraint : token_constraints ){
+      constraint.bit = bit++;
+    }
+    most = max( most, token_constraints.size() );
+  }
+  numWords = most / 64 + 1;
+  chart.resize( index( numTokens, numTokens ) + 1 );
+  satisfiedBits.resize( chart.size() * 4 * numWords );
 }
 
-
-void CKYParser::addConstraint( const Constraint *c ){
-  /// add a Constraint to our parser
+void CKYParser::addConstraint( const wcsp_constraint& c ){
+  /// add a constraint to our parser
   /*!
-    \param c the Constraint to add.
+    \param c the constraint to add.
 
-    Depending on the Constraint Type we add \e c to one of our stacks
+    Depending on the constraint type we add \e c to one of our stacks
    */
-  switch ( c->type() ){
-  case Constraint::Incoming:
-    inDepConstraints[c->tIndex()].push_back( c );
+  cky_constraint cc = { &c, c.weight, c.rel, c.direction, -1 };
+  switch ( c.type ){
+  case wcsp_constraint::Incoming:
+    inDepConstraints[c.token].push_back( cc );
     break;
-  case Constraint::Dependency:
-    edgeConstraints[c->tIndex()][c->hIndex()].push_back( c );
+  case wcsp_constraint::Dependency:
+    if ( c.head == 0 ){
+      rootConstraints[c.token].push_back( cc );
+    }
+    else {
+      edgeConstraints[c.token*(2*edgeWidth+1)
+		      + edgeWidth + c.head - c.token].push_back( cc );
+    }
     break;
-  case Constraint::Direction:
-    outDepConstraints[c->tIndex()].push_back( c );
+  case wcsp_constraint::Direction:
+    outDepConstraints[c.token].push_back( cc );
     break;
   default:
     LOG << "UNSUPPORTED constraint type" << endl;
@@ -135,182 +232,324 @@ void CKYParser::addConstraint( const Constraint *c ){
   }
 }
 
-string CKYParser::bestEdge( const SubTree& leftSubtree,
-			    const SubTree& rightSubtree,
-			    size_t headIndex,
-			    size_t depIndex,
-			    set<const Constraint*>& bestConstraints,
-			    double& bestScore ){
+const vector<cky_constraint>& CKYParser::edges( size_t depIndex,
+						size_t headIndex ) const {
+  /// return the Dependency constraints of an edge
+  /*!
+    \param depIndex the dependent
+    \param headIndex the head. 0 for the root
+    \return the constraints. Mostly empty
+  */
+  static const vector<cky_constraint> none;
+  if ( headIndex == 0 ){
+    return rootConstraints[depIndex];
+  }
+  size_t dist = headIndex > depIndex
+    ? headIndex - depIndex
+    : depIndex - headIndex;
+  if ( dist > edgeWidth ){
+    return none;
+  }
+  return edgeConstraints[depIndex*(2*edgeWidth+1) + edgeWidth
+			 + headIndex - depIndex];
+}
+
+static inline bool is_set( const uint64_t *bits, int bit ){
+  /// check if \e bit is set in the bitset \e bits
+  return ( bits[bit >> 6] >> ( bit & 63 ) ) & 1;
+}
+
+void CKYParser::set_satisfied( size_t s, size_t t, sub_tree st,
+			       const uint64_t *from,
+			       const vector<int>& extra ){
+  /// fill the satisfied set of a SubTree
+  /*!
+    \param s the start of the span
+    \param t the end of the span
+    \param st the SubTree in chart cell (s,t)
+    \param from the satisfied set of the part with the same head
+    \param extra the constraints the new edge satisfies (if any)
+  */
+  uint64_t *bits = satisfied( s, t, st );
+  for ( size_t i=0; i < numWords; ++i ){
+    bits[i] = from[i];
+  }
+  for ( const auto bit : extra ){
+    bits[bit >> 6] |= uint64_t(1) << ( bit & 63 );
+  }
+}
+
+int CKYParser::bestEdge( const uint64_t *headSatisfied,
+			 size_t headIndex,
+			 size_t depIndex,
+			 vector<int>& bestConstraints,
+			 vector<int>& scratch,
+			 double& bestScore ) const {
   /// search the best edge
-  /// I dare not to comment....
+  /*!
+    \param headSatisfied the satisfied set of the SubTree with the head
+    \param headIndex the head
+    \param depIndex the dependent
+    \param bestConstraints the incoming constraints of the head the best
+    edge satisfies
+    \param scratch working space
+    \param bestScore the score of the best edge
+    \return the label of the best edge
+
+    The direction constraints of the dependent never need a check: a
+    dependent gets only one head
+  */
   bestConstraints.clear();
-  DBG << "BESTEDGE " << headIndex << " <> " << depIndex << endl;
+  if ( debug ){
+    DBG << "BESTEDGE " << headIndex << " <> " << depIndex << endl;
+  }
   if ( headIndex == 0 ){
     bestScore = 0.0;
     for ( auto const& constraint : outDepConstraints[depIndex] ){
-      DBG << "CHECK " << constraint << endl;
-      if ( constraint->direct() == dirType::ROOT ){
-	DBG << "head outdep matched " << constraint << endl;
-	bestScore = constraint->wght();
-	bestConstraints.insert( constraint );
+      if ( debug ){
+	DBG << "CHECK " << store.to_string( *constraint.c ) << endl;
       }
+      if ( constraint.dir == dirType::ROOT ){
+	if ( debug ){
+	  DBG << "head outdep matched " << store.to_string( *constraint.c ) << endl;
+	}
+	bestScore = constraint.weight;
+      }
+    }
+    int label = ConstraintStore::ROOT_LABEL;
+    for ( auto const& constraint : edges( depIndex, 0 ) ){
+      if ( debug ){
+	DBG << "head edge matched " << store.to_string( *constraint.c ) << endl;
+      }
+      bestScore += constraint.weight;
+      label = constraint.label;
     }
-    string label = "ROOT";
-    for ( auto const& constraint : edgeConstraints[depIndex][0] ){
-      DBG << "head edge matched " << constraint << endl;
-      bestScore += constraint->wght();
-      bestConstraints.insert( constraint );
-      label = constraint->rel();
+    if ( debug ){
+      DBG << "best HEAD==>" << store.relation( label ) << " " << bestScore << endl;
     }
-    DBG << "best HEAD==>" << label << " " << bestScore << " " << bestConstraints << endl;
     return label;
   }
   bestScore = -0.5;
-  string bestLabel = "None";
-  for( auto const& edgeConstraint : edgeConstraints[depIndex][headIndex] ){
-    double my_score = edgeConstraint->wght();
-    string my_label = edgeConstraint->rel();
-    set<const Constraint *> my_constraints;
-    my_constraints.insert( edgeConstraint );
+  int bestLabel = ConstraintStore::NONE_LABEL;
+  for( auto const& edgeConstraint : edges( depIndex, headIndex ) ){
+    double my_score = edgeConstraint.weight;
+    int my_label = edgeConstraint.label;
+    scratch.clear();
     for( const auto& constraint : inDepConstraints[headIndex] ){
-      if ( constraint->rel() == my_label &&
-	   leftSubtree.satisfiedConstraints.find( constraint ) == leftSubtree.satisfiedConstraints.end() &&
-	   rightSubtree.satisfiedConstraints.find( constraint ) == rightSubtree.satisfiedConstraints.end() ){
-	DBG << "inDep matched: " << constraint << endl;
-	my_score += constraint->wght();
-	my_constraints.insert(constraint);
+      if ( constraint.label == my_label
+	   && !is_set( headSatisfied, constraint.bit ) ){
+	if ( debug ){
+	  DBG << "inDep matched: " << store.to_string( *constraint.c ) << endl;
+	}
+	my_score += constraint.weight;
+	scratch.push_back( constraint.bit );
       }
     }
     for( const auto& constraint : outDepConstraints[depIndex] ){
-      if ( ( ( constraint->direct() == LEFT &&
-	       headIndex < depIndex )
-	     ||
-	     ( constraint->direct() == RIGHT &&
-	       headIndex > depIndex ) )
-	   && leftSubtree.satisfiedConstraints.find( constraint ) == leftSubtree.satisfiedConstraints.end()
-	   && rightSubtree.satisfiedConstraints.find( constraint ) == rightSubtree.satisfiedConstraints.end() ){
-	DBG << "outdep matched: " << constraint << endl;
-	my_score += constraint->wght();
-	my_constraints.insert(constraint);
+      if ( ( constraint.dir == LEFT &&
+	     headIndex < depIndex )
+	   ||
+	   ( constraint.dir == RIGHT &&
+	     headIndex > depIndex ) ){
+	if ( debug ){
+	  DBG << "outdep matched: " << store.to_string( *constraint.c ) << endl;
+	}
+	my_score += constraint.weight;
       }
     }
     if ( my_score > bestScore ){
       bestScore = my_score;
       bestLabel = my_label;
-      bestConstraints = std::move(my_constraints);
-      DBG << "UPDATE BEst " << bestLabel << " " << bestScore << " " << bestConstraints << endl;
+      bestConstraints.swap( scratch );
+      if ( debug ){
+	DBG << "UPDATE BEst " << store.relation( bestLabel ) << " " << bestScore << endl;
+      }
     }
   }
-  DBG << "GRAND TOTAL " << bestLabel << " " << bestScore << " " << bestConstraints << endl;
+  if ( debug ){
+    DBG << "GRAND TOTAL " << store.relation( bestLabel ) << " " << bestScore << endl;
+  }
   return bestLabel;
 }
 
-void CKYParser::parse(){
-  /// run the parser
-  /// I dare not to comment
-  for ( size_t k=1; k < numTokens + 2; ++k ){
-    for( size_t s=0; s < numTokens + 1 - k; ++s ){
-      size_t t = s + k;
-      double bestScore = -10E45;
-      int bestI = -1;
-      string bestL = "__";
-      set<const Constraint*> bestConstraints;
-      for( size_t r = s; r < t; ++r ){
-	double edgeScore = -0.5;
-	set<const Constraint*> constraints;
-	string label = bestEdge( chart[s][r].r_True,
-				 chart[r+1][t].l_True,
-				 t, s, constraints, edgeScore );
-	DBG << "STEP 1 BEST EDGE==> " << label << " ( " << edgeScore << ")" << endl;
-	double score = chart[s][r].r_True.score() + chart[r+1][t].l_True.score() + edgeScore;
-	if ( score > bestScore ){
-	  bestScore = score;
-	  bestI = r;
-	  bestL = label;
-	  bestConstraints = std::move(constraints);
-	}
+void CKYParser::fill_cell( size_t s, size_t t, bool bounded,
+			   vector<int>& constraints,
+			   vector<int>& bestConstraints,
+			   vector<int>& scratch ){
+  /// fill the chart cell (s,t)
+  /*!
+    \param s the start of the span
+    \param t the end of the span
+    \param bounded when true, the span is longer than maxSpan
+    \param constraints working space
+    \param bestConstraints working space
+    \param scratch working space
+
+    Only the cells of shorter spans are used, so all cells with the same
+    span length can be filled at the same time.
+  */
+  double bestScore;
+  int bestI;
+  int bestL;
+  if ( !bounded ){
+    bestScore = -10E45;
+    bestI = -1;
+    bestL = ConstraintStore::UNSET_LABEL;
+    bestConstraints.clear();
+    for( size_t r = s; r < t; ++r ){
+      double edgeScore = -0.5;
+      int label = bestEdge( satisfied( r+1, t, L_TRUE ),
+			    t, s, constraints, scratch, edgeScore );
+      if ( debug ){
+	DBG << "STEP 1 BEST EDGE==> " << store.relation( label ) << " ( " << edgeScore << ")" << endl;
       }
-      DBG << "STEP 1 ADD: " << bestScore <<"-" << bestI << "-" << bestL << endl;
-      chart[s][t].l_False = SubTree( bestScore, bestI, bestL );
-      chart[s][t].l_False.satisfiedConstraints.insert( chart[s][bestI].r_True.satisfiedConstraints.begin(), chart[s][bestI].r_True.satisfiedConstraints.end() );
-      chart[s][t].l_False.satisfiedConstraints.insert( chart[bestI+1][t].l_True.satisfiedConstraints.begin(), chart[bestI+1][t].l_True.satisfiedConstraints.end() );
-      chart[s][t].l_False.satisfiedConstraints.insert( bestConstraints.begin(), bestConstraints.end() );
-
-      bestScore = -10E45;
-      bestI = -1;
-      bestL = "__";
-      bestConstraints.clear();
-      for ( size_t r = s; r < t; ++r ){
-	double edgeScore = -0.5;
-	set<const Constraint*> constraints;
-	string label = bestEdge( chart[s][r].r_True,
-				 chart[r+1][t].l_True,
-				 s, t, constraints, edgeScore );
-	DBG << "STEP 2 BEST EDGE==> " << label << " ( " << edgeScore << ")" << endl;
-	double score = chart[s][r].r_True.score() + chart[r+1][t].l_True.score() + edgeScore;
-	if ( score > bestScore ){
-	  bestScore = score;
-	  bestI = r;
-	  bestL = label;
-	  bestConstraints = std::move(constraints);
-	}
+      double score = cell(s,r).r_True.score() + cell(r+1,t).l_True.score() + edgeScore;
+      if ( score > bestScore ){
+	bestScore = score;
+	bestI = r;
+	bestL = label;
+	bestConstraints.swap( constraints );
       }
+    }
+    if ( debug ){
+      DBG << "STEP 1 ADD: " << bestScore <<"-" << bestI << "-" << store.relation( bestL ) << endl;
+    }
+    cell(s,t).l_False = SubTree( bestScore, bestI, bestL );
+    set_satisfied( s, t, L_FALSE,
+		   satisfied( bestI+1, t, L_TRUE ),
+		   bestConstraints );
+  }
 
-      DBG << "STEP 2 ADD: " << bestScore <<"-" << bestI << "-" << bestL << endl;
-      chart[s][t].r_False = SubTree( bestScore, bestI, bestL );
-      chart[s][t].r_False.satisfiedConstraints.insert( chart[s][bestI].r_True.satisfiedConstraints.begin(), chart[s][bestI].r_True.satisfiedConstraints.end() );
-      chart[s][t].r_False.satisfiedConstraints.insert( chart[bestI+1][t].l_True.satisfiedConstraints.begin(), chart[bestI+1][t].l_True.satisfiedConstraints.end() );
-      chart[s][t].r_False.satisfiedConstraints.insert( bestConstraints.begin(), bestConstraints.end() );
-
-      bestI = -1;
-      bestL = "";
-      bestScore = -10E45;
-      for ( size_t r = s; r < t; ++r ){
-	double score = chart[s][r].l_True.score() + chart[r][t].l_False.score();
-	if ( score > bestScore ){
-	  bestScore = score;
-	  bestI = r;
-	}
+  if ( !bounded || s == 0 ){
+    bestScore = -10E45;
+    bestI = -1;
+    bestL = ConstraintStore::UNSET_LABEL;
+    bestConstraints.clear();
+    for ( size_t r = s; r < t; ++r ){
+      double edgeScore = -0.5;
+      int label = bestEdge( satisfied( s, r, R_TRUE ),
+			    s, t, constraints, scratch, edgeScore );
+      if ( debug ){
+	DBG << "STEP 2 BEST EDGE==> " << store.relation( label ) << " ( " << edgeScore << ")" << endl;
       }
-      if ( bestI < 0 ){
-	string msg = "bestI index out of bounds in: ";
-	msg += __FILE__ + string(":") + std::to_string(__LINE__);
-	throw logic_error( msg );
+      double score = cell(s,r).r_True.score() + cell(r+1,t).l_True.score() + edgeScore;
+      if ( score > bestScore ){
+	bestScore = score;
+	bestI = r;
+	bestL = label;
+	bestConstraints.swap( constraints );
       }
-      DBG << "STEP 3 ADD: " << bestScore <<"-" << bestI << "-" << bestL << endl;
-      chart[s][t].l_True = SubTree( bestScore, bestI, bestL );
-      chart[s][t].l_True.satisfiedConstraints.insert( chart[s][bestI].l_True.satisfiedConstraints.begin(), chart[s][bestI].l_True.satisfiedConstraints.end() );
-      chart[s][t].l_True.satisfiedConstraints.insert( chart[bestI][t].l_False.satisfiedConstraints.begin(), chart[bestI][t].l_False.satisfiedConstraints.end() );
-
-      bestI = -1;
-      bestL = "";
-      bestScore = -10E45;
-      for ( size_t r = s+1; r < t+1; ++r ){
-	double score = chart[s][r].r_False.score() + chart[r][t].r_True.score();
-	if ( score > bestScore ){
-	  bestScore = score;
-	  bestI = r;
+    }
+    if ( debug ){
+      DBG << "STEP 2 ADD: " << bestScore <<"-" << bestI << "-" << store.relation( bestL ) << endl;
+    }
+    cell(s,t).r_False = SubTree( bestScore, bestI, bestL );
+    set_satisfied( s, t, R_FALSE,
+		   satisfied( s, bestI, R_TRUE ),
+		   bestConstraints );
+  }
+
+  bestI = -1;
+  bestL = ConstraintStore::EMPTY_LABEL;
+  bestScore = -10E45;
+  // when bounded, only the short l_False SubTrees exist
+  for ( size_t r = ( bounded ? t - maxSpan : s ); r < t; ++r ){
+    double score = cell(s,r).l_True.score() + cell(r,t).l_False.score();
+    if ( score > bestScore ){
+      bestScore = score;
+      bestI = r;
+    }
+  }
+  if ( bestI < 0 ){
+    string msg = "bestI index out of bounds in: ";
+    msg += __FILE__ + string(":") + std::to_string(__LINE__);
+    throw logic_error( msg );
+  }
+  if ( debug ){
+    DBG << "STEP 3 ADD: " << bestScore <<"-" << bestI << "-" << store.relation( bestL ) << endl;
+  }
+  cell(s,t).l_True = SubTree( bestScore, bestI, bestL );
+  set_satisfied( s, t, L_TRUE,
+		 satisfied( bestI, t, L_FALSE ),
+		 {} );
+
+  bestI = -1;
+  bestL = ConstraintStore::EMPTY_LABEL;
+  bestScore = -10E45;
+  // when bounded, only the short r_False SubTrees exist, except those
+  // from the root
+  size_t last = ( bounded && s > 0 ) ? s + maxSpan : t;
+  for ( size_t r = s+1; r < last+1; ++r ){
+    double score = cell(s,r).r_False.score() + cell(r,t).r_True.score();
+    if ( score > bestScore ){
+      bestScore = score;
+      bestI = r;
+    }
+  }
+  if ( bestI < 0 ){
+    string msg = "bestI index out of bounds in: ";
+    msg += __FILE__ + string(":") + std::to_string(__LINE__);
+    throw logic_error( msg );
+  }
+  if ( debug ){
+    DBG << "STEP 4 ADD: " << bestScore <<"-" << bestI << "-" << store.relation( bestL ) << endl;
+  }
+  cell(s,t).r_True = SubTree( bestScore, bestI, bestL );
+  set_satisfied( s, t, R_TRUE,
+		 satisfied( s, bestI, R_FALSE ),
+		 {} );
+}
+
+void CKYParser::parse( int threads ){
+  /// run the parser
+  /*!
+    \param threads when > 1, fill the cells of every diagonal of the chart
+    (all spans of the same length) with a team of this many OpenMP threads
+
+    This is Eisner's algorithm. When maxSpan > 0, edges longer than maxSpan
+    tokens (except from the root) are not considered. As they can't have a
+    Dependency constraint, they would only be used when there is no better
+    tree at all. The incomplete SubTrees are then only built for short spans,
+    and the complete ones only combine with those.
+  */
+  if ( debug ){
+    // our LogStream can't be shared between threads
+    threads = 1;
+  }
+  exception_ptr error;
+#pragma omp parallel num_threads( threads ) if( threads > 1 )
+  {
+    vector<int> constraints;
+    vector<int> bestConstraints;
+    vector<int> scratch;
+    for ( size_t k=1; k < numTokens + 2; ++k ){
+      bool bounded = maxSpan > 0 && k > maxSpan;
+#pragma omp for schedule( dynamic, 4 )
+      for( size_t s=0; s < numTokens + 1 - k; ++s ){
+	try {
+	  fill_cell( s, s + k, bounded,
+		     constraints, bestConstraints, scratch );
+	}
+	catch ( ... ){
+#pragma omp critical (cky_error)
+	  {
+	    if ( !error ){
+	      error = current_exception();
+	    }
+	  }
 	}
       }
-      if ( bestI < 0 ){
-	string msg = "bestI index out of bounds in: ";
-	msg += __FILE__ + string(":") + std::to_string(__LINE__);
-	throw logic_error( msg );
-      }
-      DBG << "STEP 4 ADD: " << bestScore <<"-" << bestI << "-" << bestL << endl;
-      chart[s][t].r_True = SubTree( bestScore, bestI, bestL );
-      chart[s][t].r_True.satisfiedConstraints.insert( chart[s][bestI].r_False.satisfiedConstraints.begin(), chart[s][bestI].r_False.satisfiedConstraints.end() );
-      chart[s][t].r_True.satisfiedConstraints.insert( chart[bestI][t].r_True.satisfiedConstraints.begin(), chart[bestI][t].r_True.satisfiedConstraints.end() );
-
     }
   }
+  if ( error ){
+    rethrow_exception( error );
+  }
 }
 
 void CKYParser::leftIncomplete( int s, int t, vector<parsrel>& pr ){
-  int r = chart[s][t].l_False.r();
-  string label = chart[s][t].l_False.edgeLabel();
+  int r = cell(s,t).l_False.r();
   if ( r >=0 ){
-    pr[s - 1].deprel = label;
+    pr[s - 1].deprel = store.relation( cell(s,t).l_False.edgeLabel() );
     pr[s - 1].head = t;
     rightComplete( s, r, pr );
     leftComplete( r + 1, t, pr );
@@ -318,10 +557,9 @@ void CKYParser::leftIncomplete( int s, int t, vector<parsrel>& pr ){
 }
 
 void CKYParser::rightIncomplete( int s, int t, vector<parsrel>& pr ){
-  int r = chart[s][t].r_False.r();
-  string label = chart[s][t].r_False.edgeLabel();
+  int r = cell(s,t).r_False.r();
   if ( r >= 0 ) {
-    pr[t - 1].deprel = label;
+    pr[t - 1].deprel = store.relation( cell(s,t).r_False.edgeLabel() );
     pr[t - 1].head = s;
     rightComplete( s, r, pr );
     leftComplete( r + 1, t, pr );
@@ -330,7 +568,7 @@ void CKYParser::rightIncomplete( int s, int t, vector<parsrel>& pr ){
 
 
 void CKYParser::leftComplete( int s, int t, vector<parsrel>& pr ){
-  int r = chart[s][t].l_True.r();
+  int r = cell(s,t).l_True.r();
   if ( r >= 0 ){
     leftComplete( s, r, pr );
     leftIncomplete( r, t, pr );
@@ -338,7 +576,7 @@ void CKYParser::leftComplete( int s, int t, vector<parsrel>& pr ){
 }
 
 void CKYParser::rightComplete( int s, int t, vector<parsrel>& pr ){
-  int r = chart[s][t].r_True.r();
+  int r = cell(s,t).r_True.r();
   if ( r >= 0 ){
     rightIncomplete( s, r, pr );
     rightComplete( r, t, pr );
@@ -72,13 +72,13 @@ unordered_map<string,double> split_dist( const vector< pair<string,double>>& dis
   return result;
 }
 
-vector<const Constraint*> formulateWCSP( const vector<timbl_result>& d_res,
-					 const vector<timbl_result>& r_res,
-					 const vector<timbl_result>& p_res,
-					 size_t sent_len,
-					 size_t maxDist,
-					 TiCC::LogStream *dbg_log ){
-  /// create a list of Parse Constraint records based on the 3 Timbl outputs
+ConstraintStore formulateWCSP( const vector<timbl_result>& d_res,
+			       const vector<timbl_result>& r_res,
+			       const vector<timbl_result>& p_res,
+			       size_t sent_len,
+			       size_t maxDist,
+			       TiCC::LogStream *dbg_log ){
+  /// create a store of Parse Constraints based on the 3 Timbl outputs
   /*!
     \param d_res results of the Timbl dist classifier
     \param r_res results of the Timbl relations classifier
@@ -86,8 +86,10 @@ vector<const Constraint*> formulateWCSP( const vector<timbl_result>& d_res,
     \param sent_len the sentence length
     \param maxDist the maximum distance we still handle
     \param dbg_log a LogStream for debugging
+    \return a ConstraintStore, filled using one allocation in most cases
    */
-  vector<const Constraint*> constraints;
+  // one per pair, and about 3 directions and 1 relation per token
+  ConstraintStore constraints( p_res.size() + 4 * sent_len );
   auto pit = p_res.begin();
   //  LOG << "formulate WSCP, step 1" << endl;
   for ( size_t dependent_id = 1; dependent_id <= sent_len; ++dependent_id ){
@@ -96,10 +98,7 @@ vector<const Constraint*> formulateWCSP( const vector<timbl_result>& d_res,
     ++pit;
     DBG << "class=" << top_class << " met conf " << conf << endl;
     if ( top_class != "__" ){
-      constraints.push_back( new HasDependency( dependent_id,
-						0,
-						top_class,
-						conf ) );
+      constraints.add_dependency( dependent_id, 0, top_class, conf );
     }
   }
 
@@ -119,10 +118,7 @@ vector<const Constraint*> formulateWCSP( const vector<timbl_result>& d_res,
 	++pit;
 	DBG << "class=" << top_class << " met conf " << conf << endl;
 	if ( top_class != "__" ){
-	  constraints.push_back( new HasDependency( dependent_id,
-						    headId,
-						    top_class,
-						    conf ) );
+	  constraints.add_dependency( dependent_id, headId, top_class, conf );
 	}
       }
     }
@@ -135,9 +131,7 @@ vector<const Constraint*> formulateWCSP( const vector<timbl_result>& d_res,
 	token_id <= sent_len;
 	++token_id ) {
     for ( auto const& [str,val] : dit->dist() ){
-      constraints.push_back( new DependencyDirection( token_id,
-						      str,
-						      val ) );
+      constraints.add_direction( token_id, str, val );
     }
     ++dit;
 
@@ -150,9 +144,7 @@ vector<const Constraint*> formulateWCSP( const vector<timbl_result>& d_res,
 	unordered_map<string,double> splits = split_dist( rit->dist() );
 	vector<string> clss = TiCC::split_at( top_class, "|" );
 	for( const auto& rel : clss ){
-	  constraints.push_back( new HasIncomingRel( rel_id,
-						     rel,
-						     splits[rel] ) );
+	  constraints.add_incoming( rel_id, rel, splits[rel] );
 	}
       }
       ++rit;
@@ -189,7 +181,8 @@ vector<parsrel> parse( const vector<timbl_result>& p_res,
 		       const vector<timbl_result>& d_res,
 		       size_t sent_len,
 		       int maxDist,
-		       TiCC::LogStream *dbg_log ){
+		       TiCC::LogStream *dbg_log,
+		       const cky_options& opts ){
   /// run de CKY parser using these data
   /*!
     \param p_res the Timbl pairs outcome
@@ -198,18 +191,17 @@ vector<parsrel> parse( const vector<timbl_result>& p_res,
     \param sent_len the maximum sentence lenght
     \param maxDist the maximum distance between dependents we allow
     \param dbg_log the stream used for debugging
+    \param opts how to run the CKY decoding
     \return a vector of parsrel structures
   */
-  vector<const Constraint*> constraints
+  ConstraintStore constraints
     = formulateWCSP( d_res, r_res, p_res, sent_len, maxDist, dbg_log );
   DBG << "constraints: " << endl;
   DBG << constraints << endl;
-  CKYParser parser( sent_len, constraints, dbg_log );
-  parser.parse();
+  CKYParser parser( sent_len, constraints, dbg_log,
+		    opts.bounded ? maxDist : 0, opts.debug );
+  parser.parse( opts.threads );
   vector<parsrel> result( sent_len );
   parser.rightComplete(0, sent_len, result );
-  for ( const auto& constraint : constraints ){
-    delete constraint;
-  }
   return result;
 }
@@ -0,0 +1,405 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include "config.h"
+#include "ticcutils/LogStream.h"
+#include "ticcutils/Configuration.h"
+#include "ticcutils/CommandLine.h"
+#include "ticcutils/StringOps.h"
+#include "ticcutils/json.hpp"
+#include "frog/FrogAPI.h"
+#include "frog/ucto_tokenizer_mod.h"
+
+using namespace std;
+using namespace nlohmann;
+
+typedef chrono::steady_clock bench_clock;
+
+/// the words the benchmark sentences are made of. A mix of frequent and
+/// rare words, compounds and names, so all modules have some work to do.
+/// Changing this list makes the results incomparable with older runs!
+static const vector<string> vocabulary = {
+  "de", "het", "een", "en", "maar", "omdat", "dat", "die", "niet", "wel",
+  "in", "op", "met", "naar", "over", "zonder", "tegen", "bij", "van", "ten",
+  "opzichte", "man", "vrouw", "kind", "kinderen", "huis", "huizen", "stad",
+  "boek", "tafel", "school", "leraren", "studenten", "regering", "minister",
+  "gemeente", "water", "fiets", "loopt", "zag", "heeft", "schreef", "las",
+  "gaf", "kreeg", "werkte", "fietsen", "werken", "lachen", "gisteren",
+  "altijd", "nooit", "hier", "daar", "snel", "langzaam", "mooie", "grote",
+  "oude", "eerste", "laatste", "drie", "twintig", "1998", "Jan", "Marie",
+  "Amsterdam", "Rotterdam", "Nederland", "Philips", "Europese", "Unie",
+  "voetbalwedstrijd", "ziekenhuisopname", "onafhankelijkheidsverklaring",
+  "fietsenstalling", "ongelooflijk", "belangrijkste", "onderzoekers"
+};
+
+static string configFileName = FrogAPI::defaultConfigFile("nld");
+
+void usage( ) {
+  cout << endl << "Options:\n";
+  cout << "\t -c <filename>          Set configuration file (default "
+       << configFileName << ")\n"
+       << "\t --lengths=<n,m,..>     frog corpora of sentences of 'n' tokens,"
+       << " 'm' tokens, etc.\n"
+       << "\t                        Default: 5,10,20,40\n"
+       << "\t --sentences=<n>        the number of sentences per corpus."
+       << " Default: 200\n"
+       << "\t --workers=<n,m,..>     frog every corpus with 'n' workers,"
+       << " 'm' workers, etc.\n"
+       << "\t                        Default: 1,2,4,8\n"
+       << "\t --seed=<n>             seed for generating the corpora."
+       << " Default: 42\n"
+       << "\t --skip=[mptncla]       Skip modules, as in frog\n"
+       << "\t --out=<file>           write the results as JSON to 'file'"
+       << " (default stdout)\n"
+       << "\t --baseline=<file>      compare with the results of an earlier"
+       << " run in 'file'\n"
+       << "\t -h or --help           give some help.\n"
+       << "\t -V or --version        Show version info.\n";
+}
+
+static vector<int> parse_list( const string& value, const string& option ){
+  /// parse a comma separated list of positive numbers
+  /*!
+    \param value the list
+    \param option the option name, for diagnostics
+    \return the numbers
+  */
+  vector<int> result;
+  for ( const auto& item : TiCC::split_at( value, "," ) ){
+    int num = 0;
+    if ( !TiCC::stringTo( item, num ) || num < 1 ){
+      throw runtime_error( "invalid value for --" + option + ": " + value );
+    }
+    result.push_back( num );
+  }
+  if ( result.empty() ){
+    throw runtime_error( "missing value for --" + option );
+  }
+  return result;
+}
+
+static string make_corpus( int length, int count, unsigned int seed ){
+  /// generate a corpus of sentences of a fixed length
+  /*!
+    \param length the number of tokens per sentence, including the final '.'
+    \param count the number of sentences
+    \param seed the random seed. The same seed always gives the same corpus
+    \return the corpus, one sentence per line
+  */
+  mt19937 gen( seed + length );
+  ostringstream os;
+  for ( int i=0; i < count; ++i ){
+    for ( int j=0; j < length-1; ++j ){
+      string word = vocabulary[gen() % vocabulary.size()];
+      if ( j == 0 ){
+	word[0] = toupper( word[0] );
+      }
+      os << word << " ";
+    }
+    os << "." << endl;
+  }
+  return os.str();
+}
+
+static long process_max_rss_kb(){
+  /// return the maximum resident set size of this process so far, in Kb
+  /*!
+    this never goes down, so it is the maximum over all earlier runs too
+  */
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+  return usage.ru_maxrss;
+}
+
+static long current_rss_kb(){
+  /// return the current resident set size of this process, in Kb
+  /*!
+    \return the size, or -1 when /proc/self/statm is not available
+  */
+  ifstream is( "/proc/self/statm" );
+  long size = 0;
+  long resident = 0;
+  if ( !( is >> size >> resident ) ){
+    return -1;
+  }
+  return resident * ( sysconf( _SC_PAGESIZE ) / 1024 );
+}
+
+static double seconds_since( const bench_clock::time_point& start ){
+  /// return the wall clock time since \e start, in seconds
+  return chrono::duration<double>( bench_clock::now() - start ).count();
+}
+
+static void compare( const json& result, const json& baseline ){
+  /// show the differences in throughput and stage latencies with an
+  /// earlier run
+  /*!
+    \param result the results of this run
+    \param baseline the results of the earlier run
+  */
+  if ( baseline.value( "seed", -1 ) != result["seed"]
+       || baseline.value( "sentences", -1 ) != result["sentences"] ){
+    cerr << "WARNING: the baseline used other corpora. "
+	 << "The results are not comparable" << endl;
+  }
+  map<pair<int,int>,json> old_runs;
+  for ( const auto& run : baseline.value( "runs", json::array() ) ){
+    old_runs[make_pair( run["length"].get<int>(),
+			run["workers"].get<int>() )] = run;
+  }
+  cerr << endl << "compared with the baseline (frog "
+       << baseline.value( "frog_version", "?" ) << "):" << endl;
+  for ( const auto& run : result["runs"] ){
+    auto key = make_pair( run["length"].get<int>(),
+			  run["workers"].get<int>() );
+    auto it = old_runs.find( key );
+    if ( it == old_runs.end() ){
+      continue;
+    }
+    const json& old = it->second;
+    double was = old["tokens_per_s"].get<double>();
+    double now = run["tokens_per_s"].get<double>();
+    cerr << "length " << setw(3) << key.first
+	 << " workers " << setw(2) << key.second
+	 << ": " << fixed << setprecision(1) << was << " -> " << now
+	 << " tokens/s (" << showpos << 100.0 * ( now - was ) / was
+	 << "%)" << noshowpos << endl;
+    for ( const auto& st : run["stages"].items() ){
+      if ( !old["stages"].contains( st.key() ) ){
+	continue;
+      }
+      double old_mean = old["stages"][st.key()]["mean_ms"].get<double>();
+      double new_mean = st.value()["mean_ms"].get<double>();
+      if ( old_mean > 0 ){
+	cerr << "\t" << setw(12) << left << st.key() << right
+	     << setprecision(3) << old_mean << " -> " << new_mean
+	     << " ms/sentence (" << showpos << setprecision(1)
+	     << 100.0 * ( new_mean - old_mean ) / old_mean << "%)"
+	     << noshowpos << endl;
+      }
+    }
+  }
+}
+
+int main( int argc, char *argv[] ) {
+  std::ios_base::sync_with_stdio(false);
+  cerr << "frog-bench " << VERSION << " (c) CLST, ILK 1998 - 2026" << endl;
+  TiCC::CL_Options Opts( "c:hV",
+			 "help,version,lengths:,sentences:,workers:,seed:,"
+			 "skip:,out:,baseline:" );
+  vector<int> lengths = { 5, 10, 20, 40 };
+  vector<int> workers = { 1, 2, 4, 8 };
+  int sentences = 200;
+  unsigned int seed = 42;
+  string skip;
+  string out_name;
+  json baseline;
+  try {
+    Opts.init( argc, argv );
+    if ( Opts.is_present( 'V' ) || Opts.is_present( "version" ) ){
+      return EXIT_SUCCESS;
+    }
+    if ( Opts.is_present( 'h' ) || Opts.is_present( "help" ) ){
+      usage();
+      return EXIT_SUCCESS;
+    }
+    Opts.extract( 'c', configFileName );
+    string value;
+    if ( Opts.extract( "lengths", value ) ){
+      lengths = parse_list( value, "lengths" );
+    }
+    if ( Opts.extract( "workers", value ) ){
+      workers = parse_list( value, "workers" );
+    }
+    if ( Opts.extract( "sentences", value ) ){
+      sentences = parse_list( value, "sentences" )[0];
+    }
+    if ( Opts.extract( "seed", value )
+	 && !TiCC::stringTo( value, seed ) ){
+      throw runtime_error( "invalid value for --seed: " + value );
+    }
+    Opts.extract( "skip", skip );
+    Opts.extract( "out", out_name );
+    if ( Opts.extract( "baseline", value ) ){
+      ifstream is( value );
+      if ( !is ){
+	throw runtime_error( "unable to read the baseline: " + value );
+      }
+      is >> baseline;
+    }
+  }
+  catch ( const exception& e ){
+    cerr << "fatal error: " << e.what() << endl;
+    usage();
+    return EXIT_FAILURE;
+  }
+  int max_workers = *max_element( workers.begin(), workers.end() );
+  TiCC::LogStream errLog( cerr );
+  errLog.set_message( "frog-bench-" );
+  json result;
+  result["program"] = "frog-bench";
+  result["frog_version"] = VERSION;
+  result["config"] = configFileName;
+  result["seed"] = seed;
+  result["sentences"] = sentences;
+  result["skip"] = skip;
+  result["hardware_threads"] = thread::hardware_concurrency();
+  vector<string> corpus_files;
+  try {
+    // the UctoTokenizer is timed on its own, because Frog tokenizes
+    // whole inputs and not sentence by sentence
+    TiCC::Configuration configuration;
+    if ( !configuration.fill( configFileName ) ){
+      throw runtime_error( "failed to read configuration from: "
+			   + configFileName );
+    }
+    UctoTokenizer tokenizer( &errLog );
+    if ( !tokenizer.init( configuration ) ){
+      throw runtime_error( "UCTO Initialization failed." );
+    }
+    tokenizer.setSentencePerLineInput( true );
+    // the same options as for 'frog -n'
+    vector<string> frog_args = { "frog", "-c", configFileName, "-n",
+				 "--workers=" + TiCC::toString(max_workers),
+				 "--threads=" + TiCC::toString(max_workers) };
+    if ( !skip.empty() ){
+      frog_args.push_back( "--skip=" + skip );
+    }
+    vector<const char*> frog_argv;
+    for ( const auto& arg : frog_args ){
+      frog_argv.push_back( arg.c_str() );
+    }
+    TiCC::CL_Options frog_opts( "c:n", "workers:,threads:,skip:" );
+    frog_opts.init( int(frog_argv.size()), frog_argv.data() );
+    auto start = bench_clock::now();
+    FrogAPI frog( frog_opts, &errLog, &errLog );
+    result["load_s"] = seconds_since( start );
+    result["rss_after_load_kb"] = current_rss_kb();
+    json tok_runs = json::array();
+    for ( const auto& length : lengths ){
+      string corpus = make_corpus( length, sentences, seed );
+      string name = string(P_tmpdir) + "/frog-bench." + TiCC::toString(getpid())
+	+ "." + TiCC::toString(length);
+      ofstream os( name );
+      os << corpus;
+      os.close();
+      corpus_files.push_back( name );
+      start = bench_clock::now();
+      size_t tokens = 0;
+      vector<Tokenizer::Token> toks = tokenizer.tokenize_data( corpus );
+      while ( !toks.empty() ){
+	tokens += toks.size();
+	toks = tokenizer.tokenize_next();
+      }
+      double secs = seconds_since( start );
+      tok_runs.push_back( { { "length", length },
+			    { "tokens", tokens },
+			    { "seconds", secs },
+			    { "tokens_per_s", tokens / secs } } );
+    }
+    result["tokenizer"] = tok_runs;
+    // a warm up run. The caches of the lemmatizer and the morphological
+    // analyzer stay filled, so all runs below measure a warm Frog
+    frog.Frogtostringfromfile( corpus_files[0] );
+    json runs = json::array();
+    cerr << endl << "length workers   tokens/s speedup" << endl;
+    for ( size_t i=0; i < lengths.size(); ++i ){
+      double single = 0;
+      for ( const auto& num : workers ){
+	frog.options.numWorkers = num;
+	frog.reset_stats();
+	start = bench_clock::now();
+	frog.Frogtostringfromfile( corpus_files[i] );
+	double secs = seconds_since( start );
+	json stats = frog.stats_json();
+	size_t tokens = stats["tokens"].get<size_t>();
+	double rate = tokens / secs;
+	if ( single == 0 ){
+	  single = rate;
+	}
+	runs.push_back( { { "length", lengths[i] },
+			  { "workers", num },
+			  { "sentences", stats["sentences"] },
+			  { "tokens", tokens },
+			  { "seconds", secs },
+			  { "tokens_per_s", rate },
+			  { "speedup", rate / single },
+			  { "stages", stats["stages"] },
+			  { "caches", stats["caches"] },
+			  { "rss_kb", current_rss_kb() },
+			  { "process_max_rss_kb", process_max_rss_kb() } } );
+	cerr << setw(6) << lengths[i] << setw(8) << num
+	     << setw(11) << fixed << setprecision(1) << rate
+	     << setw(8) << setprecision(2) << rate / single << endl;
+      }
+    }
+    result["runs"] = runs;
+  }
+  catch ( const exception& e ){
+    cerr << "fatal error: " << e.what() << endl;
+    for ( const auto& name : corpus_files ){
+      remove( name.c_str() );
+    }
+    return EXIT_FAILURE;
+  }
+  for ( const auto& name : corpus_files ){
+    remove( name.c_str() );
+  }
+  if ( !baseline.is_null() ){
+    compare( result, baseline );
+  }
+  if ( out_name.empty() ){
+    cout << result.dump( 2 ) << endl;
+  }
+  else {
+    ofstream os( out_name );
+    os << result.dump( 2 ) << endl;
+    cerr << "results written to: " << out_name << endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,250 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#include "frog/frog_stats.h"
+
+#include <sys/mman.h>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+#include <cstring>
+
+using namespace std;
+using namespace nlohmann;
+
+static_assert( ATOMIC_LLONG_LOCK_FREE == 2,
+	       "FrogStats needs lock-free 64 bit atomics, to be shared between "
+	       "processes" );
+
+static int bucket_of( uint64_t us ){
+  /// find the bucket for a measurement of \e us microseconds
+  /*!
+    Values below 8 get a bucket of their own. Every next power of 2 is
+    split in 4 buckets
+  */
+  if ( us < 8 ){
+    return us;
+  }
+  int msb = 63 - __builtin_clzll( us );
+  int bucket = 8 + (msb-3)*4 + ((us >> (msb-2)) & 3);
+  if ( bucket >= stage_stats::NUM_BUCKETS ){
+    bucket = stage_stats::NUM_BUCKETS - 1;
+  }
+  return bucket;
+}
+
+static uint64_t bucket_value( int bucket ){
+  /// the value that represents a bucket: the middle of its range
+  if ( bucket < 8 ){
+    return bucket;
+  }
+  int msb = (bucket - 8) / 4 + 3;
+  uint64_t quarter = uint64_t(1) << (msb-2);
+  uint64_t low = (4 + (bucket - 8) % 4) * quarter;
+  return low + quarter / 2;
+}
+
+void stage_stats::add( uint64_t us ){
+  /// add one measurement
+  /*!
+    \param us the measured time in microseconds
+  */
+  count.fetch_add( 1, memory_order_relaxed );
+  total_us.fetch_add( us, memory_order_relaxed );
+  uint64_t old_max = max_us.load( memory_order_relaxed );
+  while ( us > old_max
+	  && !max_us.compare_exchange_weak( old_max, us,
+					    memory_order_relaxed ) ){
+    // old_max is updated, try again
+  }
+  buckets[bucket_of(us)].fetch_add( 1, memory_order_relaxed );
+}
+
+uint64_t stage_stats::percentile( double p ) const {
+  /// estimate a percentile
+  /*!
+    \param p the percentile, between 0 and 1
+    \return the estimated value in microseconds. 0 when there are no
+    measurements
+  */
+  uint64_t total = 0;
+  uint64_t counts[NUM_BUCKETS];
+  for ( int i=0; i < NUM_BUCKETS; ++i ){
+    counts[i] = buckets[i].load( memory_order_relaxed );
+    total += counts[i];
+  }
+  if ( total == 0 ){
+    return 0;
+  }
+  uint64_t rank = p * total;
+  if ( rank >= total ){
+    rank = total - 1;
+  }
+  uint64_t seen = 0;
+  for ( int i=0; i < NUM_BUCKETS; ++i ){
+    seen += counts[i];
+    if ( seen > rank ){
+      return min( bucket_value( i ), max_us.load( memory_order_relaxed ) );
+    }
+  }
+  return max_us.load( memory_order_relaxed );
+}
+
+json stage_stats::to_json() const {
+  /// return the statistics as JSON. All times are in milliseconds
+  json result;
+  uint64_t cnt = count.load( memory_order_relaxed );
+  result["count"] = cnt;
+  double total = total_us.load( memory_order_relaxed ) / 1000.0;
+  result["total_ms"] = total;
+  result["mean_ms"] = ( cnt > 0 ? total / cnt : 0.0 );
+  result["p50_ms"] = percentile( 0.50 ) / 1000.0;
+  result["p95_ms"] = percentile( 0.95 ) / 1000.0;
+  result["p99_ms"] = percentile( 0.99 ) / 1000.0;
+  result["max_ms"] = max_us.load( memory_order_relaxed ) / 1000.0;
+  return result;
+}
+
+void stage_stats::reset(){
+  /// clear all counters
+  count = 0;
+  total_us = 0;
+  max_us = 0;
+  for ( auto& b : buckets ){
+    b = 0;
+  }
+}
+
+FrogStats::FrogStats(){
+  reset();
+}
+
+void FrogStats::reset(){
+  /// clear all counters, and restart the clock
+  start = time(0);
+  tokens = 0;
+  for ( auto& l : lengths ){
+    l = 0;
+  }
+  for ( auto& s : stages ){
+    s.reset();
+  }
+}
+
+FrogStats *FrogStats::create(){
+  /// create a FrogStats in shared memory
+  /*!
+    \return the new FrogStats. Free it with destroy()
+
+    Processes that are fork()ed after this call share it with us.
+  */
+  void *mem = mmap( 0, sizeof(FrogStats), PROT_READ|PROT_WRITE,
+		    MAP_SHARED|MAP_ANONYMOUS, -1, 0 );
+  if ( mem == MAP_FAILED ){
+    throw runtime_error( string("unable to map the statistics: ")
+			 + strerror(errno) );
+  }
+  return new (mem) FrogStats();
+}
+
+void FrogStats::destroy( FrogStats *stats ){
+  /// free a FrogStats made by create()
+  if ( stats ){
+    stats->~FrogStats();
+    munmap( stats, sizeof(FrogStats) );
+  }
+}
+
+const char *FrogStats::stage_name( stage s ){
+  /// the name of a stage, as used in the JSON
+  static const char *names[NUM_STAGES] = { "tagger", "lemmatizer", "mbma",
+					   "ner", "iob", "mwu", "parser",
+					   "sentence" };
+  return names[s];
+}
+
+void FrogStats::add_sentence( size_t length, uint64_t us ){
+  /// register a frogged sentence
+  /*!
+    \param length the number of tokens in the sentence
+    \param us the time it took in microseconds
+  */
+  stages[SENTENCE].add( us );
+  tokens.fetch_add( length, memory_order_relaxed );
+  size_t bucket = length == 0 ? 0 : (length-1) / LENGTH_STEP;
+  if ( bucket >= NUM_LENGTHS ){
+    bucket = NUM_LENGTHS - 1;
+  }
+  lengths[bucket].fetch_add( 1, memory_order_relaxed );
+}
+
+json FrogStats::to_json() const {
+  /// return all statistics as JSON
+  /*!
+    The rates are computed over the time since we started counting.
+  */
+  json result;
+  int64_t elapsed = time(0) - start.load();
+  if ( elapsed < 1 ){
+    elapsed = 1;
+  }
+  uint64_t sentences = stages[SENTENCE].count.load( memory_order_relaxed );
+  uint64_t toks = tokens.load( memory_order_relaxed );
+  result["elapsed_s"] = elapsed;
+  result["sentences"] = sentences;
+  result["tokens"] = toks;
+  result["sentences_per_s"] = double(sentences) / elapsed;
+  result["tokens_per_s"] = double(toks) / elapsed;
+  json st = json::object();
+  for ( int i=0; i < NUM_STAGES; ++i ){
+    if ( stages[i].count.load( memory_order_relaxed ) > 0 ){
+      st[stage_name(stage(i))] = stages[i].to_json();
+    }
+  }
+  result["stages"] = st;
+  json lens = json::array();
+  for ( int i=0; i < NUM_LENGTHS; ++i ){
+    uint64_t cnt = lengths[i].load( memory_order_relaxed );
+    if ( cnt == 0 ){
+      continue;
+    }
+    json len;
+    len["from"] = i*LENGTH_STEP + 1;
+    if ( i < NUM_LENGTHS - 1 ){
+      len["to"] = (i+1)*LENGTH_STEP;
+    }
+    len["count"] = cnt;
+    lens.push_back( len );
+  }
+  result["sentence_lengths"] = lens;
+  return result;
+}
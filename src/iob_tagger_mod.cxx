@@ -84,14 +84,11 @@ void IOBTagger::Classify( frog_data& swords ){
   */
   vector<UnicodeString> words;
   vector<UnicodeString> ptags;
-#pragma omp critical (dataupdate)
-  {
-    for ( const auto& w : swords.units ){
-      UnicodeString word = w.word;
-      word = filter_spaces( word );
-      words.push_back( word );
-      ptags.push_back( w.tag );
-    }
+  for ( const auto& w : swords.units ){
+    UnicodeString word = w.word;
+    word = filter_spaces( word );
+    words.push_back( word );
+    ptags.push_back( w.tag );
   }
 
   vector<tag_entry> to_do;
@@ -110,30 +107,31 @@ void IOBTagger::Classify( frog_data& swords ){
     }
     to_do.push_back( ta );
   }
-  _tag_result = tag_entries( to_do );
+  vector<TagResult> tag_result = tag_entries( to_do );
   if ( debug ){
     DBG << "IOB tagger out: " << endl;
-    for ( size_t i=0; i < _tag_result.size(); ++i ){
-      DBG << "[" << i << "] : word=" << _tag_result[i].word()
-	  << " tag=" << _tag_result[i].assigned_tag()
-	  << " confidence=" << _tag_result[i].confidence() << endl;
+    for ( size_t i=0; i < tag_result.size(); ++i ){
+      DBG << "[" << i << "] : word=" << tag_result[i].word()
+	  << " tag=" << tag_result[i].assigned_tag()
+	  << " confidence=" << tag_result[i].confidence() << endl;
     }
   }
-  post_process( swords );
+  post_process( swords, tag_result );
 }
 
-void IOBTagger::post_process( frog_data& sentence ){
+void IOBTagger::post_process( frog_data& sentence,
+			      const vector<TagResult>& tag_result ){
   /// finish the Chunking processs by updating 'sentence'
   /*!
     \param sentence a frog_data structure to update with Chunking info
-    from the _tag_result array.
+    \param tag_result the results of the MBT tagger
   */
   if ( debug ){
     DBG << "IOB postprocess...." << endl;
   }
   UnicodeString last_tag;
-  for ( size_t i=0; i < _tag_result.size(); ++i ){
-    UnicodeString tag = _tag_result[i].assigned_tag();
+  for ( size_t i=0; i < tag_result.size(); ++i ){
+    UnicodeString tag = tag_result[i].assigned_tag();
     if ( tag[0] == 'I' ){
       // make sure that we start a new 'sequence' with a B
       if ( last_tag.isEmpty() ){
@@ -154,7 +152,7 @@ void IOBTagger::post_process( frog_data& sentence ){
     }
     addTag( sentence.units[i],
 	    tag,
-	    _tag_result[i].confidence() );
+	    tag_result[i].confidence() );
   }
 }
 
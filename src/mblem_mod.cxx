@@ -37,9 +37,9 @@
 #include "timbl/TimblAPI.h"
 #include "ticcutils/LogStream.h"
 #include "ticcutils/Configuration.h"
-#include "ticcutils/SocketBasics.h"
 #include "ticcutils/json.hpp"
 #include "frog/Frog-util.h"
+#include "frog/server_pool.h"
 
 using namespace std;
 using namespace nlohmann;
@@ -55,6 +55,8 @@ using icu::UnicodeString;
 */
 Mblem::Mblem( TiCC::LogStream *errlog, TiCC::LogStream *dbglog ):
   myLex(0),
+  default_context(0),
+  cache(0),
   punctuation( "?...,:;\\'`(){}[]%#+-_=/!" ),
   history(20),
   debug(0),
@@ -220,6 +222,18 @@ bool Mblem::init( const TiCC::Configuration& config ) {
     keep_case = TiCC::stringTo<bool>( par );
   }
 
+  size_t cache_size = 50000;
+  par = config.lookUp( "cache_size", "mblem" );
+  if ( !par.empty() ){
+    if ( !TiCC::stringTo<size_t>( par, cache_size ) ){
+      LOG << "invalid 'cache_size' value: " << par << endl;
+      return false;
+    }
+  }
+  if ( cache_size > 0 ){
+    cache = new ResultCache<vector<UnicodeString>>( cache_size );
+  }
+
   string cls = config.lookUp( "outputclass" );
   if ( !cls.empty() ){
     textclass = cls;
@@ -237,7 +251,11 @@ bool Mblem::init( const TiCC::Configuration& config ) {
     opts += " +vs -vf -F TABBED";
     //Read in (igtree) data
     myLex = new Timbl::TimblAPI(opts);
-    return myLex->GetInstanceBase(treeName);
+    if ( !myLex->GetInstanceBase(treeName) ){
+      return false;
+    }
+    default_context = create_context();
+    return true;
   }
   else {
     string mess = check_server( _host, _port, "MBLEM" );
@@ -249,14 +267,39 @@ bool Mblem::init( const TiCC::Configuration& config ) {
     }
     else {
       LOG << "using MBLEM Timbl on " << _host << ":" << _port << endl;
+      default_context = create_context();
       return true;
     }
   }
 }
 
+MblemContext::MblemContext( const Timbl::TimblAPI *shared_lex ):
+  lex(0)
+{
+  /// create a context for one thread
+  /*!
+    \param shared_lex the Timbl tree of the Mblem model. May be 0 (when we
+    use a Timbl server)
+  */
+  if ( shared_lex ){
+    lex = new Timbl::TimblAPI( *shared_lex );
+  }
+}
+
+MblemContext::~MblemContext(){
+  delete lex;
+}
+
+MblemContext *Mblem::create_context() const {
+  /// create a new context, to run this Mblem in another thread
+  return new MblemContext( myLex );
+}
+
 Mblem::~Mblem(){
   //    LOG << "cleaning up MBLEM stuff" << endl;
   delete filter;
+  delete cache;
+  delete default_context;
   delete myLex;
   myLex = 0;
   if ( errLog != dbgLog ){
@@ -265,7 +308,7 @@ Mblem::~Mblem(){
   delete errLog;
 }
 
-UnicodeString Mblem::make_instance( const UnicodeString& in ) {
+UnicodeString Mblem::make_instance( const UnicodeString& in ) const {
   /// convert a Unicode string into an instance for Timbl
   /*!
     \param in the UnicodeString representing 1 word to lemmatize
@@ -295,15 +338,21 @@ UnicodeString Mblem::make_instance( const UnicodeString& in ) {
 }
 
 void Mblem::filterTag( const icu::UnicodeString& postag ){
+  filterTag( postag, *default_context );
+}
+
+void Mblem::filterTag( const icu::UnicodeString& postag,
+		       MblemContext& ctx ) const {
   /// filter all non-matching tags out of the mblem results
   /*!
     \param postag the tag, given by the CGN-tagger, that should match
+    \param ctx the context holding the results
 
     Mblem produces a range of possible solutions with tags. We use the POS tag
     given by the CGN tagger to remove all solutions with a different tag
   */
-  auto it = mblemResult.begin();
-  while( it != mblemResult.end() ){
+  auto it = ctx.mblemResult.begin();
+  while( it != ctx.mblemResult.end() ){
     UnicodeString tag = it->getTag();
     bool found = ( postag == tag );
     if ( !found ){
@@ -344,10 +393,10 @@ void Mblem::filterTag( const icu::UnicodeString& postag ){
 	  DBG << "compare cgn-tag " << postag << " with mblem-tag " << tag
 	      << "\n\t==> different tags. REMOVE" << endl;
 	}
-	it = mblemResult.erase(it);
+	it = ctx.mblemResult.erase(it);
       }
   }
-  if ( (debug > 1) && mblemResult.empty() ){
+  if ( (debug > 1) && ctx.mblemResult.empty() ){
     DBG << "NO CORRESPONDING TAG! " << postag << endl;
   }
 }
@@ -361,19 +410,23 @@ bool cmp_less_lemma( const mblemData& lhs, const mblemData& rhs ){
 }
 
 void Mblem::makeUnique( ){
+  makeUnique( *default_context );
+}
+
+void Mblem::makeUnique( MblemContext& ctx ) const {
   /// filter out all results that are equal
   /*
     should be called AFTER filterTag() and cleans out doubles
   */
   // unique shifts unique elements to the front, for consecutive elements
   // so mblemResult needs to be SORTED on LEMMA!
-  std::sort( mblemResult.begin(), mblemResult.end(), cmp_less_lemma );
-  auto last = std::unique(mblemResult.begin(), mblemResult.end(), cmp_eq_lemma );
+  std::sort( ctx.mblemResult.begin(), ctx.mblemResult.end(), cmp_less_lemma );
+  auto last = std::unique(ctx.mblemResult.begin(), ctx.mblemResult.end(), cmp_eq_lemma );
   // remove the rest
-  mblemResult.erase( last, mblemResult.end() );
+  ctx.mblemResult.erase( last, ctx.mblemResult.end() );
   if (debug > 1){
     DBG << "final result after filter and unique" << endl;
-    for ( const auto& mbr : mblemResult ){
+    for ( const auto& mbr : ctx.mblemResult ){
       DBG << "lemma alt: " << mbr.getLemma()
 	  << "\ttag alt: " << mbr.getTag() << endl;
     }
@@ -402,10 +455,53 @@ void Mblem::add_provenance( folia::Document& doc,
   doc.declare( folia::AnnotationType::LEMMA, tagset, args );
 }
 
+bool Mblem::special_lemma( const frog_record& fd,
+			   const UnicodeString& uword,
+			   UnicodeString& lemma ) const {
+  /// handle the words that don't need the Timbl classifier
+  /*!
+    \param fd The frog_record of the word
+    \param uword the (filtered) word
+    \param lemma the resulting lemma
+    \return true when a lemma is found, false when we need Timbl
+  */
+  const UnicodeString& pos_tag = fd.tag;
+  const UnicodeString& token_class = fd.token_class;
+  if ( token_class == "ABBREVIATION" ){
+    // We dont handle ABBREVIATION's so just take the word as such
+    lemma = uword;
+    return true;
+  }
+  auto const& it1 = token_strip_map.find( pos_tag );
+  if ( it1 != token_strip_map.end() ){
+    // some tag/tokenizer_class combinations are special
+    // we have to strip a few letters to get a lemma
+    auto const& it2 = it1->second.find( token_class );
+    if ( it2 != it1->second.end() ){
+      lemma = UnicodeString( uword, 0, uword.length() - it2->second );
+      if ( lemma.isEmpty() ){
+	lemma = uword;
+      }
+      return true;
+    }
+  }
+  if ( one_one_tags.find( pos_tag ) != one_one_tags.end() ){
+    // some tags are just taken as such
+    lemma = uword;
+    return true;
+  }
+  return false;
+}
+
 void Mblem::Classify( frog_record& fd ){
+  Classify( fd, *default_context );
+}
+
+void Mblem::Classify( frog_record& fd, MblemContext& ctx ) const {
   /// add lemma information to the frog_data
   /*!
     \param fd The frog_data
+    \param ctx the context to use. Every thread should use its own context
 
     this handles some special cases like ABBREVIATION, the token-strip rules
     and the one-one rules.
@@ -421,150 +517,217 @@ void Mblem::Classify( frog_record& fd ){
   if ( filter ){
     uword = filter->filter( uword );
   }
-  if ( token_class == "ABBREVIATION" ){
-    // We dont handle ABBREVIATION's so just take the word as such
-#pragma omp critical (dataupdate)
-    {
-      fd.lemmas.push_back( uword );
-    }
+  UnicodeString special;
+  if ( special_lemma( fd, uword, special ) ){
+    fd.lemmas.push_back( special );
     return;
   }
-
-  auto const& it1 = token_strip_map.find( pos_tag );
-  if ( it1 != token_strip_map.end() ){
-    // some tag/tokenizer_class combinations are special
-    // we have to strip a few letters to get a lemma
-    auto const& it2 = it1->second.find( token_class );
-    if ( it2 != it1->second.end() ){
-      UnicodeString uword2 = UnicodeString( uword, 0, uword.length() - it2->second );
-      if ( uword2.isEmpty() ){
-	uword2 = uword;
-      }
-#pragma omp critical (dataupdate)
-      {
-	fd.lemmas.push_back( uword2 );
-      }
+  if ( !keep_case ){
+    uword.toLower();
+  }
+  UnicodeString key;
+  if ( cache ){
+    key = uword + "\t" + pos_tag;
+    auto hit = cache->lookup( key );
+    if ( hit ){
+      fd.lemmas.insert( fd.lemmas.end(), hit->begin(), hit->end() );
       return;
     }
   }
-  if ( one_one_tags.find( pos_tag ) != one_one_tags.end() ){
-    // some tags are just taken as such
-#pragma omp critical (dataupdate)
-    {
-      fd.lemmas.push_back( uword );
+  Classify( uword, ctx );
+  filterTag( pos_tag, ctx );
+  makeUnique( ctx );
+  vector<UnicodeString> lemmas;
+  if ( ctx.mblemResult.empty() ){
+    // just return the word as a lemma
+    lemmas.push_back( uword );
+  }
+  else {
+    for ( auto const& it : ctx.mblemResult ){
+      lemmas.push_back( it.getLemma() );
     }
-    return;
   }
-  if ( !keep_case ){
-    uword.toLower();
+  fd.lemmas.insert( fd.lemmas.end(), lemmas.begin(), lemmas.end() );
+  if ( cache ){
+    cache->store( key,
+		  make_shared<const vector<UnicodeString>>( std::move(lemmas) ) );
   }
-  Classify( uword );
-  filterTag( pos_tag );
-  makeUnique();
-  if ( mblemResult.empty() ){
-    // just return the word as a lemma
-#pragma omp critical (dataupdate)
-    {
-      fd.lemmas.push_back( uword );
-    }
+}
+
+string Mblem::cache_stats() const {
+  /// return a summary of the cache usage (empty when there is no cache)
+  if ( cache ){
+    return cache->stats();
   }
-  else {
-#pragma omp critical (dataupdate)
-    {
-      for ( auto const& it : mblemResult ){
-	UnicodeString result = it.getLemma();
-	fd.lemmas.push_back( result );
-      }
+  return "";
+}
+
+bool Mblem::cache_counts( size_t& hits, size_t& misses ) const {
+  /// get the number of hits and misses of the cache
+  /*!
+    \param hits the number of hits
+    \param misses the number of misses
+    \return false when there is no cache
+  */
+  if ( !cache ){
+    return false;
+  }
+  hits = cache->hits();
+  misses = cache->misses();
+  return true;
+}
+
+void Mblem::reset_cache_counts(){
+  /// set the hit and miss counters of the cache to 0
+  if ( cache ){
+    cache->reset_counts();
+  }
+}
+
+void Mblem::Classify( frog_data& sentence ){
+  Classify( sentence, *default_context );
+}
+
+void Mblem::Classify( frog_data& sentence, MblemContext& ctx ) const {
+  /// add lemma information to all words of a sentence
+  /*!
+    \param sentence the (tagged) sentence to lemmatize
+    \param ctx the context to use. Every thread should use its own context
+
+    Handling a whole sentence at once is much cheaper then starting a task
+    for every single word.
+    When using a Timbl server, all words are sent in one request.
+  */
+  if ( !_host.empty() ){
+    prefetch( sentence, ctx );
+  }
+  for ( auto& word : sentence.units ){
+    Classify( word, ctx );
+  }
+  ctx.remote_classes.clear();
+}
+
+void Mblem::prefetch( const frog_data& sentence, MblemContext& ctx ) const {
+  /// ask the Timbl server for all instances of a sentence in one go
+  /*!
+    \param sentence the sentence
+    \param ctx the context to store the answers in
+
+    only words that will really be handed to Timbl are included. Every
+    instance is sent once.
+  */
+  vector<UnicodeString> insts;
+  for ( const auto& fd : sentence.units ){
+    UnicodeString uword = fd.word;
+    if ( filter ){
+      uword = filter->filter( uword );
+    }
+    UnicodeString special;
+    if ( special_lemma( fd, uword, special ) ){
+      continue;
+    }
+    if ( !keep_case ){
+      uword.toLower();
     }
+    if ( cache && cache->contains( uword + "\t" + fd.tag ) ){
+      continue;
+    }
+    UnicodeString inst = make_instance( uword );
+    if ( ctx.remote_classes.find( inst ) == ctx.remote_classes.end() ){
+      ctx.remote_classes[inst] = "";
+      insts.push_back( inst );
+    }
+  }
+  if ( insts.empty() ){
+    return;
+  }
+  vector<UnicodeString> classes = call_server( insts );
+  for ( size_t i=0; i < insts.size(); ++i ){
+    ctx.remote_classes[insts[i]] = classes[i];
   }
 }
 
-UnicodeString Mblem::call_server( const UnicodeString& instance ){
+UnicodeString Mblem::call_server( const UnicodeString& instance ) const {
   /// use a Timbl server to classify
   /*!
     \param instance The instance to give to Timbl
     \return the lemma rule as returned by Timbl
   */
-  Sockets::ClientSocket client;
-  if ( !client.connect( _host, _port ) ){
-    LOG << "failed to open connection, " << _host
-	<< ":" << _port << endl
-	<< "Reason: " << client.getMessage() << endl;
-    exit( EXIT_FAILURE );
-  }
   if ( debug > 1 ){
     DBG << "calling MBLEM-server" << endl;
   }
-  string in_line;
-  client.read( in_line );
-  json response;
-  try {
-    response = json::parse( in_line );
-  }
-  catch ( const exception& e ){
-    LOG << "json parsing failed on '" << in_line << "':"
-	<< e.what() << endl;
-    abort();
-  }
-  //  LOG << "received json data:" << response.dump(2) << endl;
-  if ( !_base.empty() ){
-    json out_json;
-    out_json["command"] = "base";
-    out_json["param"] = _base;
-    string out_line = out_json.dump() + "\n";
-    //    LOG << "sending BASE json data:" << out_line << endl;
-    client.write( out_line );
-    client.read( in_line );
-    try {
-      response = json::parse( in_line );
-    }
-    catch ( const exception& e ){
-      LOG << "json parsing failed on '" << in_line << "':"
-	  << e.what() << endl;
-      abort();
-    }
-    //    LOG << "received json data:" << response.dump(2) << endl;
-  }
   // create json query struct
   json query;
   query["command"] = "classify";
   query["param"] = TiCC::UnicodeToUTF8(instance,_normalizer);
-  //  LOG << "send json" << query.dump(2) << endl;
-  // send it to the server
-  string out_line = query.dump() + "\n";
-  client.write( out_line );
-  // receive json
-  client.read( in_line );
-  //  LOG << "received line:" << in_line << "" << endl;
-  try {
-    response = json::parse( in_line );
-  }
-  catch ( const exception& e ){
-    LOG << "json parsing failed on '" << in_line << "':"
-	<< e.what() << endl;
-    abort();
-  }
+  json response = ServerPool::get( _host, _port, _base )->call( query );
   //  LOG << "received json data:" << response.dump(2) << endl;
   string result = response["category"];
   //  LOG << "extracted result " << result << endl;
   return TiCC::UnicodeFromUTF8(result,_normalizer);
 }
 
+vector<UnicodeString> Mblem::call_server( const vector<UnicodeString>& insts ) const {
+  /// use a Timbl server to classify a list of instances in one request
+  /*!
+    \param insts The instances to give to Timbl
+    \return the lemma rules as returned by Timbl, one per instance
+  */
+  if ( debug > 1 ){
+    DBG << "calling MBLEM-server for " << insts.size() << " instances" << endl;
+  }
+  json query;
+  query["command"] = "classify";
+  json arr = json::array();
+  for ( const auto& i : insts ){
+    arr.push_back( TiCC::UnicodeToUTF8(i,_normalizer) );
+  }
+  query["params"] = arr;
+  json response = ServerPool::get( _host, _port, _base )->call( query );
+  vector<UnicodeString> result;
+  if ( !response.is_array() ){
+    result.push_back( TiCC::UnicodeFromUTF8(response["category"],_normalizer) );
+  }
+  else {
+    for ( const auto& it : response.items() ){
+      result.push_back( TiCC::UnicodeFromUTF8(it.value()["category"],_normalizer) );
+    }
+  }
+  if ( result.size() != insts.size() ){
+    throw runtime_error( "MBLEM-server returned " + TiCC::toString(result.size())
+			 + " answers for " + TiCC::toString(insts.size())
+			 + " instances" );
+  }
+  return result;
+}
+
 void Mblem::Classify( const icu::UnicodeString& uWord ){
+  Classify( uWord, *default_context );
+}
+
+void Mblem::Classify( const icu::UnicodeString& uWord,
+		      MblemContext& ctx ) const {
   /// give the lemma for 1 word
   /*!
     \param uWord a Unicode string with the word
+    \param ctx the context to use
     the internal mblemResult struct will be filled with 1 or more (alternative)
     solutions of a lemma + a POS-tag
   */
-  mblemResult.clear();
+  ctx.mblemResult.clear();
   UnicodeString inst = make_instance(uWord);
   UnicodeString u_class;
   if ( !_host.empty() ){
-    u_class = call_server( inst );
+    auto it = ctx.remote_classes.find( inst );
+    if ( it != ctx.remote_classes.end() ){
+      u_class = it->second;
+    }
+    else {
+      u_class = call_server( inst );
+    }
   }
   else {
-    myLex->Classify( inst, u_class );
+    ctx.lex->Classify( inst, u_class );
   }
   if ( debug > 1){
     DBG << "class: " << u_class  << endl;
@@ -678,12 +841,12 @@ void Mblem::Classify( const icu::UnicodeString& uWord ){
     if ( debug > 1 ){
       DBG << "appending lemma " << lemma << " and tag " << restag << endl;
     }
-    mblemResult.push_back( mblemData( lemma, restag ) );
+    ctx.mblemResult.push_back( mblemData( lemma, restag ) );
   } // while
   if ( debug > 1) {
-    DBG << "stored lemma and tag options: " << mblemResult.size()
-	<< " lemma's and " << mblemResult.size() << " tags:" << endl;
-    for ( const auto& mbr : mblemResult ){
+    DBG << "stored lemma and tag options: " << ctx.mblemResult.size()
+	<< " lemma's and " << ctx.mblemResult.size() << " tags:" << endl;
+    for ( const auto& mbr : ctx.mblemResult ){
       DBG << "lemma alt: " << mbr.getLemma()
 	  << "\ttag alt: " << mbr.getTag() << endl;
     }
@@ -691,9 +854,13 @@ void Mblem::Classify( const icu::UnicodeString& uWord ){
 }
 
 vector<pair<UnicodeString,UnicodeString> > Mblem::getResult() const {
-  /// extract the results into a list of lemma/tag pairs
+  return getResult( *default_context );
+}
+
+vector<pair<UnicodeString,UnicodeString> > Mblem::getResult( const MblemContext& ctx ) const {
+  /// extract the results from a context into a list of lemma/tag pairs
   vector<pair<UnicodeString,UnicodeString> > result;
-  for ( const auto& mbr : mblemResult ){
+  for ( const auto& mbr : ctx.mblemResult ){
     result.push_back( make_pair( mbr.getLemma(),
 				 mbr.getTag() ) );
   }
@@ -357,6 +357,26 @@ BracketNest::~BracketNest(){
   //  LOG << "DELETED NEST: " << (void *)this << endl;
 }
 
+BracketLeaf *BracketLeaf::clone() const {
+  /// return a (deep) copy of this leaf
+  return new BracketLeaf( *this );
+}
+
+BracketNest *BracketNest::clone() const {
+  /// return a deep copy of this node and all its parts
+  BracketNest *result = new BracketNest( cls,
+					 _compound,
+					 debugFlag,
+					 myLog,
+					 _normalizer );
+  result->RightHand = RightHand;
+  result->_status = _status;
+  for ( const auto *p : _parts ){
+    result->_parts.push_back( p->clone() );
+  }
+  return result;
+}
+
 UnicodeString BaseBracket::put( bool ) const {
   /// create a descriptive UTF8 string representation for this object
   UnicodeString result = "[err?]" + CLEX::get_tag_descr(cls);
@@ -44,9 +44,9 @@
 #include "ticcutils/PrettyPrint.h"
 #include "ticcutils/StringOps.h"
 #include "ticcutils/Unicode.h"
-#include "ticcutils/SocketBasics.h"
 #include "ticcutils/json.hpp"
 #include "frog/Frog-util.h"
+#include "frog/server_pool.h"
 #include "frog/FrogData.h"
 
 using namespace std;
@@ -62,6 +62,8 @@ const long int RIGHT = 6; // right context
 
 Mbma::Mbma( TiCC::LogStream *errlog, TiCC::LogStream *dbglog ):
   MTree(0),
+  default_context(0),
+  cache(0),
   filter(0),
   debugFlag(0),
   filter_diac(false),
@@ -91,8 +93,9 @@ string Mbma::clex_tagset = "http://ilk.uvt.nl/folia/sets/frog-mbpos-clex";
 
 Mbma::~Mbma() {
   /// the mbma destructor
+  delete cache;
+  delete default_context;
   delete MTree;
-  clearAnalysis();
   delete filter;
   if ( errLog != dbgLog ){
     delete dbgLog;
@@ -256,6 +259,21 @@ bool Mbma::init( const TiCC::Configuration& config ) {
   if ( !dof.empty() ){
     filter_diac = TiCC::stringTo<bool>( dof );
   }
+  size_t cache_size = 50000;
+  val = config.lookUp( "cache_size", "mbma" );
+  if ( !val.empty() ){
+    if ( !TiCC::stringTo<size_t>( val, cache_size ) ){
+      LOG << "invalid 'cache_size' value: " << val << endl;
+      return false;
+    }
+  }
+  if ( cache_size > 0 ){
+    cache = new ResultCache<mbma_result>( cache_size );
+    val = config.lookUp( "cache_file", "mbma" );
+    if ( !val.empty() ){
+      cache_file = prefix( config.configDir(), val );
+    }
+  }
 
   string cls = config.lookUp( "outputclass" );
   if ( !cls.empty() ){
@@ -279,7 +297,12 @@ bool Mbma::init( const TiCC::Configuration& config ) {
     }
     opts += " +vs -vf"; // make Timbl run quietly
     MTree = new Timbl::TimblAPI(opts);
-    return MTree->GetInstanceBase(MTreeFilename);
+    if ( !MTree->GetInstanceBase(MTreeFilename) ){
+      return false;
+    }
+    default_context = create_context();
+    fill_cache();
+    return true;
   }
   else {
     string mess = check_server( _host, _port, "MBMA" );
@@ -291,12 +314,14 @@ bool Mbma::init( const TiCC::Configuration& config ) {
     }
     else {
       LOG << "using MBMA Timbl on " << _host << ":" << _port << endl;
+      default_context = create_context();
+      fill_cache();
       return true;
     }
   }
 }
 
-vector<UnicodeString> Mbma::make_instances( const icu::UnicodeString& word ){
+vector<UnicodeString> Mbma::make_instances( const icu::UnicodeString& word ) const {
   /// convert a Unicode string into a range of UTF8 instances for Timbl
   /*!
     \param word the UnicodeString representing 1 word to analyze
@@ -405,16 +430,167 @@ vector<vector<UnicodeString> > generate_all_perms( const vector<UnicodeString>&
   return result;
 }
 
-void Mbma::clearAnalysis(){
+MbmaContext::MbmaContext( const Timbl::TimblAPI *shared_tree ):
+  tree(0)
+{
+  /// create a context for one thread
+  /*!
+    \param shared_tree the Timbl tree of the Mbma model. May be 0 (when we
+    use a Timbl server)
+
+    We use a child of the shared tree, which shares the instance base,
+    but has its own private classification state.
+  */
+  if ( shared_tree ){
+    tree = new Timbl::TimblAPI( *shared_tree );
+  }
+}
+
+MbmaContext::~MbmaContext(){
+  clear();
+  delete tree;
+}
+
+void MbmaContext::clear(){
+  /// remove all analyses
   for ( const auto& a: analysis ){
     delete a;
   }
   analysis.clear();
 }
 
+mbma_result::~mbma_result(){
+  for ( const auto *b : morph_structure ){
+    delete b;
+  }
+}
+
+void mbma_result::store( const frog_record& fd ){
+  /// take a (deep) copy of the Mbma results in \e fd
+  morph_string = fd.morph_string;
+  compound_string = fd.compound_string;
+  for ( const auto *b : fd.morph_structure ){
+    morph_structure.push_back( b->clone() );
+  }
+}
+
+void mbma_result::restore( frog_record& fd ) const {
+  /// add a (deep) copy of the stored results to \e fd
+  fd.morph_string = morph_string;
+  fd.compound_string = compound_string;
+  for ( const auto *b : morph_structure ){
+    fd.morph_structure.push_back( b->clone() );
+  }
+}
+
+MbmaContext *Mbma::create_context() const {
+  /// create a new context, to run this Mbma in another thread
+  return new MbmaContext( MTree );
+}
+
+void Mbma::setDeepMorph( bool b ){
+  /// switch deep morphological analysis on or off
+  /*!
+    \param b the new value
+
+    The cached results depend on this value, so the cache is refilled
+    when it changes.
+  */
+  if ( b != doDeepMorph ){
+    doDeepMorph = b;
+    if ( cache ){
+      cache->clear();
+      fill_cache();
+    }
+  }
+}
+
+void Mbma::fill_cache(){
+  /// preload the cache with the words from cache_file
+  /*!
+    Every line of the file holds a word and its POS tag, and optionally the
+    POS tag of the next word, separated by TABs. Lines starting with '#' are
+    comments. The words are analyzed and the results are stored in the cache.
+    Afterwards the hit and miss counters are reset.
+  */
+  if ( !cache || cache_file.empty() ){
+    return;
+  }
+  ifstream is( cache_file );
+  if ( !is ){
+    LOG << "unable to open MBMA cache file: " << cache_file
+	<< " (ignored)" << endl;
+    return;
+  }
+  size_t count = 0;
+  UnicodeString line;
+  while ( TiCC::getline( is, _normalizer, line ) ){
+    line.trim();
+    if ( line.isEmpty() || line[0] == '#' ){
+      continue;
+    }
+    vector<UnicodeString> parts = TiCC::split_at( line, "\t" );
+    if ( parts.size() < 2 ){
+      LOG << "invalid line in " << cache_file << ": " << line << endl;
+      continue;
+    }
+    frog_record fd;
+    fd.word = parts[0];
+    fd.tag = parts[1];
+    if ( parts.size() > 2 ){
+      fd.next_tag = parts[2];
+    }
+    try {
+      Classify( fd, *default_context );
+      ++count;
+    }
+    catch ( const exception& e ){
+      LOG << "unable to analyze '" << line << "' from " << cache_file
+	  << ": " << e.what() << endl;
+    }
+  }
+  // the preloading itself should not count in the cache statistics
+  cache->reset_counts();
+  LOG << "preloaded the MBMA cache with " << count << " words" << endl;
+}
+
+string Mbma::cache_stats() const {
+  /// return a summary of the cache usage (empty when there is no cache)
+  if ( cache ){
+    return cache->stats();
+  }
+  return "";
+}
+
+bool Mbma::cache_counts( size_t& hits, size_t& misses ) const {
+  /// get the number of hits and misses of the cache
+  /*!
+    \param hits the number of hits
+    \param misses the number of misses
+    \return false when there is no cache
+  */
+  if ( !cache ){
+    return false;
+  }
+  hits = cache->hits();
+  misses = cache->misses();
+  return true;
+}
+
+void Mbma::reset_cache_counts(){
+  /// set the hit and miss counters of the cache to 0
+  if ( cache ){
+    cache->reset_counts();
+  }
+}
+
+void Mbma::clearAnalysis(){
+  default_context->clear();
+}
+
 Rule* Mbma::matchRule( const std::vector<icu::UnicodeString>& ana,
 		       const icu::UnicodeString& word,
-		       bool keep_V2I ){
+		       bool keep_V2I ) const {
   /// attempt to match an Analysis on a word
   /*!
     \param ana one analysis result, expanded from the Timbl classifier
@@ -463,7 +639,7 @@ bool check_next( const UnicodeString& tag ){
 
 vector<Rule*> Mbma::execute( const icu::UnicodeString& word,
 			     const icu::UnicodeString& next_tag,
-			     const vector<icu::UnicodeString>& classes ){
+			     const vector<icu::UnicodeString>& classes ) const {
   /// attempt to find matching Rules
   /*!
     \param word a word to check
@@ -563,10 +739,16 @@ struct id_cmp {
 };
 
 void Mbma::filterHeadTag( const icu::UnicodeString& head ){
+  filterHeadTag( head, *default_context );
+}
+
+void Mbma::filterHeadTag( const icu::UnicodeString& head,
+			  MbmaContext& ctx ) const {
   /// reduce the Mbms analysis by removing all solutions where the head is not
   /// matched
   /*!
     \param head the head-tag that is required
+    \param ctx the context holding the analyses
     matching does not mean equality. We are a forgivingful in the sense that
     \verbatim
     N matches PN
@@ -579,7 +761,7 @@ void Mbma::filterHeadTag( const icu::UnicodeString& head ){
     DBG << "filter with head: " << head << endl;
     DBG << "filter: analysis is:" << endl;
     int i=0;
-    for ( const auto *it : analysis ){
+    for ( const auto *it : ctx.analysis ){
       DBG << ++i << " - " << it << endl;
     }
   }
@@ -593,8 +775,8 @@ void Mbma::filterHeadTag( const icu::UnicodeString& head ){
   if (debugFlag > 1){
     DBG << "#matches: CGN:" << head << " CELEX " << celex_tag << endl;
   }
-  auto ait = analysis.begin();
-  while ( ait != analysis.end() ){
+  auto ait = ctx.analysis.begin();
+  while ( ait != ctx.analysis.end() ){
     UnicodeString mbma_tag = CLEX::toUnicodeString((*ait)->tag);
     if ( celex_tag == mbma_tag ){
       if (debugFlag > 1){
@@ -635,22 +817,28 @@ void Mbma::filterHeadTag( const icu::UnicodeString& head ){
 	    << mbma_tag << " (rejected)" << endl;
       }
       delete *ait;
-      ait = analysis.erase( ait );
+      ait = ctx.analysis.erase( ait );
     }
   }
   if (debugFlag > 1){
     DBG << "filter: analysis after head filter:" << endl;
     int i=0;
-    for ( const auto *it : analysis ){
+    for ( const auto *it : ctx.analysis ){
       DBG << ++i << " - " << it << endl;
     }
   }
 }
 
 void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
+  filterSubTags( feats, *default_context );
+}
+
+void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats,
+			  MbmaContext& ctx ) const {
   /// reduce the analyses set based on sub-features
   /*!
     \param feats a list of subfeatures
+    \param ctx the context holding the analyses
     when a candidate Rule has inflexion it should match a feature.
 
     Other criteria: only take the highest confidence, and remove Rules that
@@ -664,7 +852,7 @@ void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
     so this is a good reading
     \endverbatim
   */
-  if ( analysis.size() < 1 ){
+  if ( ctx.analysis.size() < 1 ){
     if (debugFlag > 1){
       DBG << "analysis is empty so skip next filter" << endl;
     }
@@ -678,7 +866,7 @@ void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
   // and match with inflections from each m
   set<Rule *, id_cmp> bestMatches; // store rules on ID, maybe overkill?
   int max_count = 0;
-  for ( const auto& q : analysis ){
+  for ( const auto& q : ctx.analysis ){
     int match_count = 0;
     UnicodeString inflection = q->inflection;
     if ( inflection.isEmpty() ){
@@ -737,11 +925,11 @@ void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
     }
   }
   // now we can remove all analysis that aren't in the set.
-  auto ana = analysis.begin();
-  while ( ana != analysis.end() ){
+  auto ana = ctx.analysis.begin();
+  while ( ana != ctx.analysis.end() ){
     if ( highConf.find( *ana ) == highConf.end() ){
       delete *ana;
-      ana = analysis.erase( ana );
+      ana = ctx.analysis.erase( ana );
     }
     else {
       ++ana;
@@ -755,7 +943,7 @@ void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
   if ( debugFlag > 1){
     DBG << "filter: analysis before sort key:" << endl;
     int i=0;
-    for ( const auto *a_it : analysis ){
+    for ( const auto *a_it : ctx.analysis ){
       DBG << ++i << " - " << a_it << " " << a_it->getKey()
 	  << " (" << a_it->getKey().length() << ")" << endl;
     }
@@ -776,11 +964,11 @@ void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
     uniqueAna.insert( uit.second );
   }
   // now we can remove all analysis that aren't in that set.
-  ana = analysis.begin();
-  while ( ana != analysis.end() ){
+  ana = ctx.analysis.begin();
+  while ( ana != ctx.analysis.end() ){
     if ( uniqueAna.find( *ana ) == uniqueAna.end() ){
       delete *ana;
-      ana = analysis.erase( ana );
+      ana = ctx.analysis.erase( ana );
     }
     else {
       ++ana;
@@ -789,7 +977,7 @@ void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
   if ( debugFlag > 1){
     DBG << "filter: analysis before sort on length:" << endl;
     int i=0;
-    for ( const auto *a_it : analysis ){
+    for ( const auto *a_it : ctx.analysis ){
       DBG << ++i << " - " << a_it << " " << a_it->getKey()
 	  << " (" << a_it->getKey().length() << ")" << endl;
     }
@@ -799,12 +987,12 @@ void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
   // We assume the 'longest' analysis to be the best.
   // So we prefer '[ge][maak][t]' over '[gemaak][t]'
   // Therefor we sort on (unicode) string length
-  sort( analysis.begin(), analysis.end(), mbmacmp );
+  sort( ctx.analysis.begin(), ctx.analysis.end(), mbmacmp );
 
   if ( debugFlag > 1){
     DBG << "filter: definitive analysis:" << endl;
     int i=0;
-    for ( auto const *a_it : analysis ){
+    for ( auto const *a_it : ctx.analysis ){
       DBG << ++i << " - " << a_it << endl;
     }
     DBG << "done filtering" << endl;
@@ -813,8 +1001,12 @@ void Mbma::filterSubTags( const vector<icu::UnicodeString>& feats ){
 }
 
 void Mbma::assign_compounds(){
-  /// add compound information to the result
-  for ( auto const& sit : analysis ){
+  assign_compounds( *default_context );
+}
+
+void Mbma::assign_compounds( MbmaContext& ctx ) const {
+  /// add compound information to the analyses in the context
+  for ( auto const& sit : ctx.analysis ){
     sit->compound = sit->brackets->speculateCompoundType();
   }
 }
@@ -851,10 +1043,7 @@ void Mbma::store_morphemes( frog_record& fd,
     for ( const auto& m : morphemes ){
       out += "[" + m + "]";
     }
-#pragma omp critical (dataupdate)
-    {
-      fd.morph_string = out;
-    }
+    fd.morph_string = out;
   }
 }
 
@@ -932,10 +1121,7 @@ void Mbma::store_brackets( frog_record& fd,
     DBG << "store_brackets(" << fd.word << "," << orig_word
 	<< "," << brackets << ")" << endl;
   }
-#pragma omp critical (dataupdate)
-  {
-    fd.morph_structure.push_back( brackets );
-  }
+  fd.morph_structure.push_back( brackets );
   return;
 }
 
@@ -983,8 +1169,9 @@ UnicodeString flatten( const UnicodeString& in ){
 
 void Mbma::storeResult( frog_record& fd,
 			const UnicodeString& uword,
-			const UnicodeString& uhead ) const {
-  if ( analysis.size() == 0 ){
+			const UnicodeString& uhead,
+			MbmaContext& ctx ) const {
+  if ( ctx.analysis.size() == 0 ){
     // fallback option: use the word and pretend it's a morpheme ;-)
     if ( debugFlag > 1){
       DBG << "no matches found, use the word instead: "
@@ -996,7 +1183,7 @@ void Mbma::storeResult( frog_record& fd,
     store_morphemes( fd, tmp );
   }
   else {
-    vector<pair<UnicodeString,string>> pv = getResults();
+    vector<pair<UnicodeString,string>> pv = getResults( ctx );
     if ( doDeepMorph ){
       fd.morph_string = pv[0].first;
     }
@@ -1009,7 +1196,7 @@ void Mbma::storeResult( frog_record& fd,
     else {
       fd.compound_string = pv[0].second;
     }
-    for ( auto& sit : analysis ){
+    for ( auto& sit : ctx.analysis ){
       store_brackets( fd, uword, sit->brackets );
       store_morphemes( fd, sit->extract_morphemes() );
       sit->brackets = NULL;
@@ -1018,6 +1205,15 @@ void Mbma::storeResult( frog_record& fd,
 }
 
 void Mbma::Classify( frog_record& fd ){
+  Classify( fd, *default_context );
+}
+
+void Mbma::Classify( frog_record& fd, MbmaContext& ctx ) const {
+  /// run the Mbma analysis on one word of a sentence
+  /*!
+    \param fd the frog_record to analyze, and to store the results in
+    \param ctx the context to use. Every thread should use its own context
+  */
   UnicodeString word = fd.word;
   UnicodeString tag = fd.tag;
   UnicodeString token_class = fd.token_class;
@@ -1048,59 +1244,114 @@ void Mbma::Classify( frog_record& fd ){
     UnicodeString lWord = word;
     lWord.toLower();
     fd.clean_word = lWord;
-    Classify( lWord, fd.next_tag );
+    UnicodeString key;
+    if ( cache ){
+      // the next tag is only looked at by check_next()
+      key = lWord + "\t" + tag + "\t" + (check_next( fd.next_tag )?"1":"0");
+      ResultCache<mbma_result>::value_ptr hit = cache->lookup( key );
+      if ( hit ){
+	hit->restore( fd );
+	return;
+      }
+    }
+    Classify( lWord, fd.next_tag, ctx );
     vector<UnicodeString> featVals;
     if ( v.size() > 1 ){
       featVals = TiCC::split_at( v[1], "," );
     }
-    filterHeadTag( head );
-    filterSubTags( featVals );
-    assign_compounds();
-    storeResult( fd, lWord, head );
+    filterHeadTag( head, ctx );
+    filterSubTags( featVals, ctx );
+    assign_compounds( ctx );
+    storeResult( fd, lWord, head, ctx );
+    if ( cache ){
+      auto result = make_shared<mbma_result>();
+      result->store( fd );
+      cache->store( key, result );
+    }
   }
 }
 
-void Mbma::call_server( const vector<UnicodeString>& insts,
-			vector<UnicodeString>& classes ){
-  Sockets::ClientSocket client;
-  if ( !client.connect( _host, _port ) ){
-    LOG << "failed to open connection, " << _host
-	<< ":" << _port << endl
-	<< "Reason: " << client.getMessage() << endl;
-    exit( EXIT_FAILURE );
-  }
-  if ( debugFlag > 1 ){
-    DBG << "calling MBMA-server" << endl;
-  }
-  string in_line;
-  client.read( in_line );
-  json response;
-  try {
-    response = json::parse( in_line );
+void Mbma::Classify( frog_data& sentence ){
+  Classify( sentence, *default_context );
+}
+
+void Mbma::Classify( frog_data& sentence, MbmaContext& ctx ) const {
+  /// run the Mbma analysis on all words of a sentence
+  /*!
+    \param sentence the (tagged) sentence to analyze
+    \param ctx the context to use. Every thread should use its own context
+
+    Handling a whole sentence at once is much cheaper then starting a task
+    for every single word.
+    When using a Timbl server, all words are sent in one request.
+  */
+  if ( !_host.empty() ){
+    prefetch( sentence, ctx );
   }
-  catch ( const exception& e ){
-    string err_msg = "json parsing failed on '" + in_line + "':" + e.what();
-    LOG << err_msg << endl;
-    throw( runtime_error( err_msg ) );
+  for ( auto& word : sentence.units ){
+    Classify( word, ctx );
   }
-  //  LOG << "received json data:" << response.dump(2) << endl;
-  if ( !_base.empty() ){
-    json out_json;
-    out_json["command"] = "base";
-    out_json["param"] = _base;
-    string out_line = out_json.dump() + "\n";
-    //    LOG << "sending BASE json data:" << out_line << endl;
-    client.write( out_line );
-    client.read( in_line );
-    try {
-      response = json::parse( in_line );
+  ctx.remote_classes.clear();
+}
+
+void Mbma::prefetch( const frog_data& sentence, MbmaContext& ctx ) const {
+  /// ask the Timbl server for the instances of all words of a sentence at once
+  /*!
+    \param sentence the sentence
+    \param ctx the context to store the answers in, per word
+
+    only words that will really be handed to Timbl are included. Every
+    word is sent once. The answers are split up again per word.
+  */
+  vector<UnicodeString> words;
+  vector<UnicodeString> insts;
+  vector<size_t> offsets;
+  for ( const auto& fd : sentence.units ){
+    UnicodeString head = TiCC::split_at_first_of( fd.tag, "()" )[0];
+    if ( head == "LET"
+	 || head == "SPEC"
+	 || fd.token_class == "ABBREVIATION" ){
+      continue;
     }
-    catch ( const exception& e ){
-      string err_msg = "json parsing failed on '" + in_line + "':" + e.what();
-      LOG << err_msg << endl;
-      throw( runtime_error( err_msg ) );
+    UnicodeString word = TiCC::join( TiCC::split( fd.word ), "" );
+    if ( filter ){
+      word = filter->filter( word );
     }
-    //    LOG << "received json data:" << response.dump(2) << endl;
+    word.toLower();
+    if ( cache
+	 && cache->contains( word + "\t" + fd.tag + "\t"
+			     + (check_next( fd.next_tag )?"1":"0") ) ){
+      continue;
+    }
+    if ( filter_diac ){
+      word = TiCC::filter_diacritics( word );
+    }
+    if ( ctx.remote_classes.find( word ) != ctx.remote_classes.end() ){
+      continue;
+    }
+    ctx.remote_classes[word];
+    words.push_back( word );
+    offsets.push_back( insts.size() );
+    vector<UnicodeString> word_insts = make_instances( word );
+    insts.insert( insts.end(), word_insts.begin(), word_insts.end() );
+  }
+  if ( insts.empty() ){
+    return;
+  }
+  offsets.push_back( insts.size() );
+  vector<UnicodeString> classes;
+  classes.reserve( insts.size() );
+  call_server( insts, classes );
+  for ( size_t i=0; i < words.size(); ++i ){
+    ctx.remote_classes[words[i]].assign( classes.begin() + offsets[i],
+					 classes.begin() + offsets[i+1] );
+  }
+}
+
+void Mbma::call_server( const vector<UnicodeString>& insts,
+			vector<UnicodeString>& classes ) const {
+  if ( debugFlag > 1 ){
+    DBG << "calling MBMA-server" << endl;
   }
   // create json struct
   json query;
@@ -1110,24 +1361,10 @@ void Mbma::call_server( const vector<UnicodeString>& insts,
     arr.push_back( TiCC::UnicodeToUTF8(i,_normalizer) );
   }
   query["params"] = arr;
-  //  LOG << "send json" << query.dump(2) << endl;
-  // send it to the server
-  string out_line = query.dump() + "\n";
-  client.write( out_line );
-  // receive json
-  client.read( in_line );
-  //  LOG << "received line:" << in_line << "" << endl;
-  try {
-    response = json::parse( in_line );
-  }
-  catch ( const exception& e ){
-    string err_msg = "json parsing failed on '" + in_line + "':" + e.what();
-    LOG << err_msg << endl;
-    throw( runtime_error( err_msg ) );
-  }
+  json response = ServerPool::get( _host, _port, _base )->call( query );
   //  LOG << "received json data:" << response.dump(2) << endl;
-  assert( response.size() == insts.size() );
-  if ( response.size() == 1 ){
+  // a single instance gives a single object, not an array
+  if ( !response.is_array() ){
     classes.push_back( TiCC::UnicodeFromUTF8(response["category"],_normalizer) );
   }
   else {
@@ -1135,11 +1372,22 @@ void Mbma::call_server( const vector<UnicodeString>& insts,
       classes.push_back( TiCC::UnicodeFromUTF8(it.value()["category"],_normalizer) );
     }
   }
+  if ( classes.size() != insts.size() ){
+    throw runtime_error( "MBMA-server returned " + TiCC::toString(classes.size())
+			 + " answers for " + TiCC::toString(insts.size())
+			 + " instances" );
+  }
 }
 
 void Mbma::Classify( const icu::UnicodeString& word,
 		     const icu::UnicodeString& next_tag ){
-  clearAnalysis();
+  Classify( word, next_tag, *default_context );
+}
+
+void Mbma::Classify( const icu::UnicodeString& word,
+		     const icu::UnicodeString& next_tag,
+		     MbmaContext& ctx ) const {
+  ctx.clear();
   icu::UnicodeString uWord = word;
   if ( filter_diac ){
     uWord = TiCC::filter_diacritics( uWord );
@@ -1149,16 +1397,22 @@ void Mbma::Classify( const icu::UnicodeString& word,
   classes.reserve( insts.size() );
   //  LOG << "made instances: " << insts << endl;
   if ( !_host.empty() ){
-    call_server( insts, classes );
+    auto it = ctx.remote_classes.find( uWord );
+    if ( it != ctx.remote_classes.end() ){
+      classes = it->second;
+    }
+    else {
+      call_server( insts, classes );
+    }
   }
   else {
     int i = 0;
     for ( auto const& inst : insts ) {
       UnicodeString ans;
-      MTree->Classify( inst, ans );
+      ctx.tree->Classify( inst, ans );
       if ( debugFlag > 1){
 	DBG << "itt #" << i+1 << " " << insts[i] << " ==> " << ans
-	    << ", depth=" << MTree->matchDepth() << endl;
+	    << ", depth=" << ctx.tree->matchDepth() << endl;
 	++i;
       }
       classes.push_back( ans );
@@ -1169,12 +1423,17 @@ void Mbma::Classify( const icu::UnicodeString& word,
   if ( classes[0] == "0" ){
     classes[0] = "X";
   }
-  analysis = execute( uWord, next_tag, classes );
+  ctx.analysis = execute( uWord, next_tag, classes );
 }
 
 vector<pair<UnicodeString,string>> Mbma::getResults( bool shrt ) const {
+  return getResults( *default_context, shrt );
+}
+
+vector<pair<UnicodeString,string>> Mbma::getResults( const MbmaContext& ctx,
+						     bool shrt ) const {
   vector<pair<UnicodeString,string>> result;
-  for ( const auto *it : analysis ){
+  for ( const auto *it : ctx.analysis ){
     UnicodeString us = it->pretty_string( shrt );
     string cmp = toString( it->compound );
     result.push_back( make_pair(us, cmp) );
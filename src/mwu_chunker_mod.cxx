@@ -129,7 +129,18 @@ bool Mwu::read_mwus( const string& fname) {
   /// fill our table with MWU's
   /*!
     \param fname the file to reaf from
+
+    When 'fname' is an image, made by compile(), it is used as is.
    */
+  if ( Gazetteer::is_image( fname ) ){
+    if ( !table.load( fname ) ){
+      LOG << "invalid compiled mwu file " << fname << endl;
+      return false;
+    }
+    LOG << "loaded " << table.entries() << " compiled mwus from "
+	<< fname << endl;
+    return true;
+  }
   LOG << "read mwus " + fname << endl;
   ifstream mwufile(fname, ios::in);
   if ( !mwufile ){
@@ -143,9 +154,7 @@ bool Mwu::read_mwus( const string& fname) {
       vector<UnicodeString> res2 = TiCC::split_at(res1[0], "_");;
       //res1 has mwus and tags, res2 has ind. words
       if ( res2.size() >= 2 ){
-	UnicodeString key = res2[0];
-	res2.erase(res2.begin());
-	MWUs.insert( make_pair( key, res2 ) );
+	table.add( res2, "mwu" );
       }
       else {
 	LOG << "invalid entry in MWU file " << line << endl;
@@ -160,6 +169,47 @@ bool Mwu::read_mwus( const string& fname) {
   return true;
 }
 
+bool Mwu::find_mwu_file( const TiCC::Configuration& config ){
+  /// set mwuFileName, using the 't' value from the configuration
+  string val = config.lookUp( "t", "mwu" );
+  if ( val.empty() ){
+    LOG << "cannot find attribute 't' in configfile" << endl;
+    return false;
+  }
+  mwuFileName = prefix( config.configDir(), val );
+  return true;
+}
+
+bool Mwu::compile( const TiCC::Configuration& config,
+		   const string& image ){
+  /// compile the mwu file from the configuration into an image
+  /*!
+    \param config the configuration
+    \param image the file to write the image to
+    \return true on succes
+
+    The image can be used as the 't' value in the configuration instead of
+    the original file. It is loaded without any parsing, see Gazetteer::load()
+  */
+  if ( !find_mwu_file( config ) ){
+    return false;
+  }
+  if ( !read_mwus( mwuFileName ) ){
+    LOG << "Cannot read mwu file " << mwuFileName << endl;
+    return false;
+  }
+  if ( table.is_mapped() ){
+    LOG << "'" << mwuFileName << "' is already compiled" << endl;
+    return false;
+  }
+  if ( !table.save( image ) ){
+    LOG << "unable to write the mwu image: " << image << endl;
+    return false;
+  }
+  LOG << "wrote " << table.entries() << " mwus to: " << image << endl;
+  return true;
+}
+
 bool Mwu::init( const TiCC::Configuration& config ) {
   /// initialize the Mwu using a Configuration structure
   /*!
@@ -174,12 +224,9 @@ bool Mwu::init( const TiCC::Configuration& config ) {
   if ( !val.empty() ){
     debug = TiCC::stringTo<int>( val );
   }
-  val = config.lookUp( "t", "mwu" );
-  if ( val.empty() ){
-    LOG << "cannot find attribute 't' in configfile" << endl;
+  if ( !find_mwu_file( config ) ){
     return false;
   }
-  mwuFileName = prefix( config.configDir(), val );
   if ( !read_mwus(mwuFileName) ) {
     LOG << "Cannot read mwu file " << mwuFileName << endl;
     return false;
@@ -305,7 +352,6 @@ void Mwu::Classify(){
   if ( debug > 1 ) {
     DBG << "Starting mwu Classify" << endl;
   }
-  mymap2::iterator best_match;
   size_t matchLength = 0;
   size_t max = mWords.size();
 
@@ -322,63 +368,72 @@ void Mwu::Classify(){
       MWUs.insert( make_pair(key, newmwu) );
     }
   }
+  vector<UnicodeString> words;
+  for ( const auto& mw : mWords ){
+    words.push_back( mw->getWord() );
+  }
   size_t i;
   for ( i = 0; i < max; i++) {
-    UnicodeString word = mWords[i]->getWord();
+    UnicodeString word = words[i];
     if ( debug > 1 ){
       DBG << "checking word[" << i <<"]: " << word << endl;
     }
-    auto matches = MWUs.equal_range(word);
-    if ( i == 0
-	 && matches.first == matches.second ) {
+    bool known = table.is_prefix( word ) || MWUs.count( word ) > 0;
+    if ( i == 0 && !known ){
       // no match on first word. try decaped version.
       // we do this ONLY for the very first word in the sentence!
       word = decap( word );
       if ( debug > 1 ){
      	DBG << "checking decapped word [" << i <<"]: " << word << endl;
       }
-      matches = MWUs.equal_range(word);
+      words[0] = word;
+      known = table.is_prefix( word ) || MWUs.count( word ) > 0;
     }
-    if ( matches.first != matches.second ) {
+    if ( known ) {
       //match
-      auto current_match = matches.first;
       if (  debug > 1 ) {
 	DBG << "MWU: match found for " << word << endl;
       }
-      while( current_match != matches.second
-	     && current_match != MWUs.end() ){
-	vector<UnicodeString> match = current_match->second;
+      // the longest match in our table
+      size_t table_match = table.longest_match( words, i );
+      if ( table_match > 1 ){
+	matchLength = table_match - 1;
+      }
+      // and in the sequences of glue words we have seen
+      auto matches = MWUs.equal_range( word );
+      for ( auto current_match = matches.first;
+	    current_match != matches.second;
+	    ++current_match ){
+	const vector<UnicodeString>& match = current_match->second;
 	size_t max_match = match.size();
 	size_t j = 0;
 	if ( debug > 1 ){
 	  DBG << "checking " << max_match << " matches:" << endl;
 	}
 	for (; i + j + 1 < max && j < max_match; j++) {
-	  if ( match[j] != mWords[i+j+1]->getWord() ) {
+	  if ( match[j] != words[i+j+1] ) {
 	    if ( debug > 1){
 	      DBG << "match " << j <<" (" << match[j]
 			   << ") doesn't match with word " << i+ j + 1
-			   << " (" << mWords[i+j + 1]->getWord() <<")" << endl;
+			   << " (" << words[i+j+1] <<")" << endl;
 	    }
 	    // mismatch in jth word of current mwu
 	    break;
 	  }
 	  else if ( debug > 1 ){
-	    DBG << " matched " <<  mWords[i+j+1]->getWord()
+	    DBG << " matched " <<  words[i+j+1]
 			 << " j=" << j << endl;
 	  }
 
 	}
 	if (j == max_match && j > matchLength ){
 	  // a match. remember this!
-	  best_match = current_match;
 	  matchLength = j;
 	}
-	++current_match;
-      } // while
+      }
       if( debug > 1){
 	if (matchLength >0 ) {
-	  DBG << "MWU: found match starting with " << (*best_match).first << endl;
+	  DBG << "MWU: found match starting with " << word << endl;
 	}
 	else {
 	  DBG <<"MWU: no match" << endl;
@@ -0,0 +1,548 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#include "frog/ner_gazetteer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace icu;
+
+namespace {
+  const char gaz_magic[8] = { 'F','R','O','G','G','A','Z','\0' };
+  const uint32_t gaz_version = 1;
+
+  /// \brief the layout of the start of a compiled Gazetteer image
+  ///
+  /// all offsets are in bytes, from the start of the image, and are
+  /// 8-byte aligned
+  struct gaz_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;  ///< 0x01020304 as written by the compiling host
+    uint64_t entries;
+    uint64_t max_length;
+    uint64_t categories;
+    uint64_t tokens;
+    uint64_t nodes;
+    uint64_t edges;
+    uint64_t category_offset;  ///< NUL terminated category names
+    uint64_t token_index_offset;
+    uint64_t token_pool_offset;
+    uint64_t node_edges_offset;
+    uint64_t node_masks_offset;
+    uint64_t edge_tokens_offset;
+    uint64_t edge_nodes_offset;
+    uint64_t size;
+  };
+
+  size_t align8( size_t pos ){
+    return (pos + 7) & ~size_t(7);
+  }
+
+  void write_block( ostream& os, const void *data, size_t len ){
+    os.write( static_cast<const char*>(data), len );
+    static const char pad[8] = {0};
+    size_t rest = align8( len ) - len;
+    os.write( pad, rest );
+  }
+}
+
+Gazetteer::Gazetteer():
+  _entries( 0 ),
+  _nodes( 1 ),
+  _max_length( 0 ),
+  _image( 0 ),
+  _image_size( 0 ),
+  _tokens( 0 ),
+  token_index( 0 ),
+  token_pool( 0 ),
+  node_edges( 0 ),
+  node_masks( 0 ),
+  edge_tokens( 0 ),
+  edge_nodes( 0 )
+{
+  /// create an empty Gazetteer, with only a root node
+  masks.push_back( 0 );
+}
+
+Gazetteer::~Gazetteer(){
+  unmap();
+}
+
+void Gazetteer::unmap(){
+  /// release the mmap()-ed image, if any
+  if ( _image ){
+    munmap( const_cast<char*>(_image), _image_size );
+    _image = 0;
+    _image_size = 0;
+  }
+}
+
+bool Gazetteer::add( const vector<UnicodeString>& tokens,
+		     const string& cat ){
+  /// add a Named Entity
+  /*!
+    \param tokens the tokens that make up the NE
+    \param cat the NE category
+    \return false when there are too many different categories, or when the
+    Gazetteer is a loaded image
+
+    Adding the same sequence with another category is fine. Adding it again
+    with the same category is a no-op.
+  */
+  if ( _image ){
+    return false;
+  }
+  if ( tokens.empty() ){
+    return true;
+  }
+  uint32_t bit = 0;
+  auto cit = find( categories.begin(), categories.end(), cat );
+  if ( cit == categories.end() ){
+    if ( categories.size() == 32 ){
+      return false;
+    }
+    bit = categories.size();
+    categories.push_back( cat );
+  }
+  else {
+    bit = cit - categories.begin();
+  }
+  uint32_t node = 0;
+  for ( const auto& tok : tokens ){
+    auto tit = token_ids.find( tok );
+    uint32_t tok_id;
+    if ( tit == token_ids.end() ){
+      tok_id = token_ids.size();
+      token_ids.emplace( tok, tok_id );
+    }
+    else {
+      tok_id = tit->second;
+    }
+    uint64_t key = edge_key( node, tok_id );
+    auto eit = edges.find( key );
+    if ( eit == edges.end() ){
+      uint32_t next = masks.size();
+      masks.push_back( 0 );
+      edges.emplace( key, next );
+      node = next;
+    }
+    else {
+      node = eit->second;
+    }
+  }
+  if ( masks[node] == 0 ){
+    ++_entries;
+  }
+  masks[node] |= (1u << bit);
+  _nodes = masks.size();
+  _max_length = max( _max_length, tokens.size() );
+  return true;
+}
+
+int64_t Gazetteer::token_id( const UnicodeString& word ) const {
+  /// find the number of a token
+  /*!
+    \param word the token to search
+    \return the number, or -1 when unknown
+  */
+  if ( _image ){
+    size_t low = 0;
+    size_t high = _tokens;
+    while ( low < high ){
+      size_t mid = low + (high - low) / 2;
+      int32_t len = token_index[mid+1] - token_index[mid];
+      int8_t cmp = word.compare( token_pool + token_index[mid], len );
+      if ( cmp == 0 ){
+	return mid;
+      }
+      else if ( cmp > 0 ){
+	low = mid + 1;
+      }
+      else {
+	high = mid;
+      }
+    }
+    return -1;
+  }
+  auto tit = token_ids.find( word );
+  if ( tit == token_ids.end() ){
+    return -1;
+  }
+  return tit->second;
+}
+
+int64_t Gazetteer::child( uint32_t node, uint32_t tok ) const {
+  /// find the node reached from 'node' by token 'tok'
+  /*!
+    \param node the starting node
+    \param tok the token number
+    \return the next node, or -1 when there is none
+  */
+  if ( _image ){
+    const uint32_t *begin = edge_tokens + node_edges[node];
+    const uint32_t *end = edge_tokens + node_edges[node+1];
+    const uint32_t *pos = std::lower_bound( begin, end, tok );
+    if ( pos == end || *pos != tok ){
+      return -1;
+    }
+    return edge_nodes[pos - edge_tokens];
+  }
+  auto eit = edges.find( edge_key( node, tok ) );
+  if ( eit == edges.end() ){
+    return -1;
+  }
+  return eit->second;
+}
+
+vector<set<string>> Gazetteer::lookup( const vector<UnicodeString>& words ) const {
+  /// find all known NE's in a sentence
+  /*!
+    \param words the sentence, as a list of tokens
+    \return a set of categories for every word. Empty for words that are not
+    part of any NE.
+
+    Every word is looked up in the token table only once. From every position
+    we then walk the trie as long as the sequence is known.
+  */
+  vector<int64_t> ids( words.size(), -1 );
+  for ( size_t i=0; i < words.size(); ++i ){
+    ids[i] = token_id( words[i] );
+  }
+  vector<uint32_t> found( words.size(), 0 );
+  for ( size_t j=0; j < words.size(); ++j ){
+    uint32_t node = 0;
+    for ( size_t i=j; i < words.size() && i-j < _max_length; ++i ){
+      if ( ids[i] < 0 ){
+	break;
+      }
+      int64_t next = child( node, ids[i] );
+      if ( next < 0 ){
+	break;
+      }
+      node = next;
+      uint32_t m = mask( node );
+      if ( m != 0 ){
+	for ( size_t k=j; k <= i; ++k ){
+	  found[k] |= m;
+	}
+      }
+    }
+  }
+  vector<set<string>> result( words.size() );
+  for ( size_t i=0; i < words.size(); ++i ){
+    for ( size_t b=0; b < categories.size(); ++b ){
+      if ( found[i] & (1u << b) ){
+	result[i].insert( categories[b] );
+      }
+    }
+  }
+  return result;
+}
+
+size_t Gazetteer::longest_match( const vector<UnicodeString>& words,
+				 size_t start ) const {
+  /// find the longest known sequence at a position in a sentence
+  /*!
+    \param words the sentence, as a list of tokens
+    \param start the position to start at
+    \return the number of tokens in the longest known sequence starting at
+    \e start. 0 when there is none
+  */
+  size_t result = 0;
+  uint32_t node = 0;
+  for ( size_t i=start; i < words.size() && i-start < _max_length; ++i ){
+    int64_t tok = token_id( words[i] );
+    if ( tok < 0 ){
+      break;
+    }
+    int64_t next = child( node, tok );
+    if ( next < 0 ){
+      break;
+    }
+    node = next;
+    if ( mask( node ) != 0 ){
+      result = i - start + 1;
+    }
+  }
+  return result;
+}
+
+bool Gazetteer::is_prefix( const UnicodeString& word ) const {
+  /// check if there is a known sequence starting with \e word
+  int64_t tok = token_id( word );
+  return tok >= 0 && child( 0, tok ) >= 0;
+}
+
+bool Gazetteer::save( const string& file_name ) const {
+  /// write the Gazetteer as a binary image
+  /*!
+    \param file_name the file to create
+    \return true on succes
+
+    The image holds a sorted table of all tokens, the category bitmask of
+    every node and the edges of every node, sorted on token number. These
+    can be searched in place, after load()-ing the image.
+  */
+  if ( _image ){
+    return false;
+  }
+  // renumber the tokens in sorted order
+  vector<const UnicodeString*> sorted( token_ids.size() );
+  for ( const auto& it : token_ids ){
+    sorted[it.second] = &it.first;
+  }
+  std::sort( sorted.begin(), sorted.end(),
+	     []( const UnicodeString *a, const UnicodeString *b ){
+	       return *a < *b; } );
+  vector<uint32_t> new_id( sorted.size() );
+  vector<uint32_t> tok_index( sorted.size() + 1 );
+  vector<UChar> pool;
+  for ( size_t i=0; i < sorted.size(); ++i ){
+    new_id[token_ids.at(*sorted[i])] = i;
+    tok_index[i] = pool.size();
+    pool.insert( pool.end(),
+		 sorted[i]->getBuffer(),
+		 sorted[i]->getBuffer() + sorted[i]->length() );
+  }
+  tok_index[sorted.size()] = pool.size();
+  // group the edges per node
+  vector<vector<pair<uint32_t,uint32_t>>> children( masks.size() );
+  for ( const auto& it : edges ){
+    uint32_t node = it.first >> 32;
+    uint32_t tok = it.first & 0xffffffff;
+    children[node].push_back( make_pair( new_id[tok], it.second ) );
+  }
+  vector<uint32_t> first( masks.size() + 1 );
+  vector<uint32_t> e_tokens;
+  vector<uint32_t> e_nodes;
+  e_tokens.reserve( edges.size() );
+  e_nodes.reserve( edges.size() );
+  for ( size_t n=0; n < children.size(); ++n ){
+    std::sort( children[n].begin(), children[n].end() );
+    first[n] = e_tokens.size();
+    for ( const auto& c : children[n] ){
+      e_tokens.push_back( c.first );
+      e_nodes.push_back( c.second );
+    }
+  }
+  first[children.size()] = e_tokens.size();
+  string cats;
+  for ( const auto& c : categories ){
+    cats += c;
+    cats += '\0';
+  }
+  gaz_header head;
+  memset( &head, 0, sizeof(head) );
+  memcpy( head.magic, gaz_magic, sizeof(gaz_magic) );
+  head.version = gaz_version;
+  head.byte_order = 0x01020304;
+  head.entries = _entries;
+  head.max_length = _max_length;
+  head.categories = categories.size();
+  head.tokens = sorted.size();
+  head.nodes = masks.size();
+  head.edges = e_tokens.size();
+  size_t pos = align8( sizeof(head) );
+  head.category_offset = pos;
+  pos += align8( cats.size() );
+  head.token_index_offset = pos;
+  pos += align8( tok_index.size() * sizeof(uint32_t) );
+  head.token_pool_offset = pos;
+  pos += align8( pool.size() * sizeof(UChar) );
+  head.node_edges_offset = pos;
+  pos += align8( first.size() * sizeof(uint32_t) );
+  head.node_masks_offset = pos;
+  pos += align8( masks.size() * sizeof(uint32_t) );
+  head.edge_tokens_offset = pos;
+  pos += align8( e_tokens.size() * sizeof(uint32_t) );
+  head.edge_nodes_offset = pos;
+  pos += align8( e_nodes.size() * sizeof(uint32_t) );
+  head.size = pos;
+  ofstream os( file_name, ios::binary );
+  if ( !os ){
+    return false;
+  }
+  write_block( os, &head, sizeof(head) );
+  write_block( os, cats.data(), cats.size() );
+  write_block( os, tok_index.data(), tok_index.size() * sizeof(uint32_t) );
+  write_block( os, pool.data(), pool.size() * sizeof(UChar) );
+  write_block( os, first.data(), first.size() * sizeof(uint32_t) );
+  write_block( os, masks.data(), masks.size() * sizeof(uint32_t) );
+  write_block( os, e_tokens.data(), e_tokens.size() * sizeof(uint32_t) );
+  write_block( os, e_nodes.data(), e_nodes.size() * sizeof(uint32_t) );
+  return os.good();
+}
+
+bool Gazetteer::is_image( const string& file_name ){
+  /// check if a file is a compiled Gazetteer image
+  ifstream is( file_name, ios::binary );
+  char magic[sizeof(gaz_magic)];
+  if ( !is.read( magic, sizeof(magic) ) ){
+    return false;
+  }
+  return memcmp( magic, gaz_magic, sizeof(gaz_magic) ) == 0;
+}
+
+bool Gazetteer::load( const string& file_name ){
+  /// use a Gazetteer image, made by save()
+  /*!
+    \param file_name the image file
+    \return true on succes. On failure the Gazetteer is left empty.
+
+    The image is mapped read-only into memory, nothing is copied or parsed,
+    except for the list of category names.
+  */
+  unmap();
+  token_ids.clear();
+  edges.clear();
+  masks.assign( 1, 0 );
+  categories.clear();
+  _entries = 0;
+  _nodes = 1;
+  _max_length = 0;
+  int fd = open( file_name.c_str(), O_RDONLY );
+  if ( fd < 0 ){
+    return false;
+  }
+  struct stat st;
+  if ( fstat( fd, &st ) != 0
+       || size_t(st.st_size) < sizeof(gaz_header) ){
+    close( fd );
+    return false;
+  }
+  void *mem = mmap( 0, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if ( mem == MAP_FAILED ){
+    return false;
+  }
+  _image = static_cast<const char*>(mem);
+  _image_size = st.st_size;
+  const gaz_header *head = reinterpret_cast<const gaz_header*>(_image);
+  auto inside = [&]( uint64_t off, uint64_t len ){
+    return off <= _image_size && len <= _image_size - off;
+  };
+  if ( memcmp( head->magic, gaz_magic, sizeof(gaz_magic) ) != 0
+       || head->version != gaz_version
+       || head->byte_order != 0x01020304
+       || head->size != _image_size
+       || head->nodes < 1
+       || head->categories > 32
+       || !inside( head->token_index_offset, (head->tokens+1)*sizeof(uint32_t) )
+       || !inside( head->node_edges_offset, (head->nodes+1)*sizeof(uint32_t) )
+       || !inside( head->node_masks_offset, head->nodes*sizeof(uint32_t) )
+       || !inside( head->edge_tokens_offset, head->edges*sizeof(uint32_t) )
+       || !inside( head->edge_nodes_offset, head->edges*sizeof(uint32_t) ) ){
+    unmap();
+    return false;
+  }
+  token_index = reinterpret_cast<const uint32_t*>(_image + head->token_index_offset);
+  token_pool = reinterpret_cast<const UChar*>(_image + head->token_pool_offset);
+  node_edges = reinterpret_cast<const uint32_t*>(_image + head->node_edges_offset);
+  node_masks = reinterpret_cast<const uint32_t*>(_image + head->node_masks_offset);
+  edge_tokens = reinterpret_cast<const uint32_t*>(_image + head->edge_tokens_offset);
+  edge_nodes = reinterpret_cast<const uint32_t*>(_image + head->edge_nodes_offset);
+  if ( !inside( head->token_pool_offset,
+		size_t(token_index[head->tokens]) * sizeof(UChar) )
+       || node_edges[head->nodes] != head->edges
+       || head->category_offset > head->token_index_offset ){
+    unmap();
+    return false;
+  }
+  // lookups trust these arrays without further checks, so make sure once
+  // that every range and every edge stays inside the image
+  for ( uint64_t i=0; i < head->tokens; ++i ){
+    if ( token_index[i] > token_index[i+1] ){
+      unmap();
+      return false;
+    }
+  }
+  for ( uint64_t i=0; i < head->nodes; ++i ){
+    if ( node_edges[i] > node_edges[i+1] ){
+      unmap();
+      return false;
+    }
+  }
+  for ( uint64_t i=0; i < head->edges; ++i ){
+    if ( edge_nodes[i] >= head->nodes ){
+      unmap();
+      return false;
+    }
+  }
+  const char *cat = _image + head->category_offset;
+  const char *cat_end = _image + head->token_index_offset;
+  for ( uint64_t i=0; i < head->categories; ++i ){
+    const char *nul = static_cast<const char*>(memchr( cat, '\0', cat_end - cat ));
+    if ( !nul ){
+      unmap();
+      categories.clear();
+      return false;
+    }
+    categories.push_back( string( cat, nul ) );
+    cat = nul + 1;
+  }
+  _tokens = head->tokens;
+  _nodes = head->nodes;
+  _entries = head->entries;
+  _max_length = head->max_length;
+  masks.clear();
+  return true;
+}
+
+size_t Gazetteer::memory_usage() const {
+  /// give a rough estimate of the memory used, in bytes
+  /*!
+    for a loaded image this is the size of the (shared) mapping
+  */
+  if ( _image ){
+    return sizeof(*this) + _image_size;
+  }
+  size_t result = sizeof(*this);
+  result += masks.capacity() * sizeof(uint32_t);
+  // a hash node holds the value, a next pointer and the cached hash
+  result += edges.size() * ( sizeof(pair<const uint64_t,uint32_t>)
+			     + 2 * sizeof(void*) );
+  result += edges.bucket_count() * sizeof(void*);
+  for ( const auto& it : token_ids ){
+    result += sizeof(it) + 2 * sizeof(void*)
+      + it.first.length() * sizeof(UChar);
+  }
+  result += token_ids.bucket_count() * sizeof(void*);
+  return result;
+}
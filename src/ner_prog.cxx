@@ -40,6 +40,8 @@
 #include "ticcutils/Configuration.h"
 #include "ticcutils/CommandLine.h"
 #include "ticcutils/PrettyPrint.h"
+#include "ticcutils/StringOps.h"
+#include "ticcutils/Timer.h"
 #include "libfolia/folia.h"
 #include "mbt/MbtAPI.h"
 #include "frog/ucto_tokenizer_mod.h"
@@ -52,6 +54,9 @@ TiCC::LogStream my_default_log( cerr );
 TiCC::LogStream *theErrLog = &my_default_log;  // fill the externals
 
 vector<string> fileNames;
+string benchFileName;
+string gazetImage;
+string overrideImage;
 
 TiCC::Configuration configuration;
 static string configDir = string(SYSCONF_PATH) + "/" + PACKAGE + "/";
@@ -64,6 +69,12 @@ void usage( ) {
   cout << "\t============= INPUT MODE (mandatory, choose one) ========================\n"
        << "\t -t <testfile>          Run NER on this file\n"
        << "\t -c <filename>    Set configuration file (default " << configFileName << ")\n"
+       << "\t --gazet-bench=<file> Only time the gazetteer lookups for the\n"
+       << "\t                  sentences in 'file' and show the gazetteer size\n"
+       << "\t --compile-gazetteer=<image> Compile the 'known_ners' gazetteers\n"
+       << "\t                  from the configuration into 'image'\n"
+       << "\t --compile-override=<image> Compile the 'ner_override' gazetteers\n"
+       << "\t                  from the configuration into 'image'\n"
        << "\t============= OTHER OPTIONS ============================================\n"
        << "\t -h. give some help.\n"
        << "\t -V or --version .   Show version info.\n"
@@ -102,6 +113,19 @@ bool parse_args( TiCC::CL_Options& Opts ) {
     configuration.setatt( "debug", value, "NER" );
   };
 
+  Opts.extract( "compile-gazetteer", gazetImage );
+  Opts.extract( "compile-override", overrideImage );
+  if ( !gazetImage.empty() || !overrideImage.empty() ){
+    return true;
+  }
+  if ( Opts.extract( "gazet-bench", benchFileName ) ){
+    ifstream is( benchFileName );
+    if ( !is ){
+      cerr << "input stream " << benchFileName << " is not readable" << endl;
+      return false;
+    }
+    return true;
+  }
   if ( Opts.extract( 't', value ) ){
     ifstream is( value );
     if ( !is ){
@@ -147,6 +171,37 @@ void Test( istream& in ){
   }
 }
 
+void Bench( istream& in ){
+  vector<vector<UnicodeString>> sentences;
+  size_t word_cnt = 0;
+  while ( in.good() ){
+    UnicodeString sentence = tokenizer.tokenizeStream( in );
+    if ( sentence.isEmpty() ){
+      break;
+    }
+    sentences.push_back( TiCC::split( sentence ) );
+    word_cnt += sentences.back().size();
+  }
+  const Gazetteer& gaz = tagger.gazetteer();
+  cout << "gazetteer: " << gaz.entries() << " entries, "
+       << gaz.nodes() << " nodes, longest entry " << gaz.max_length()
+       << " tokens, ~" << gaz.memory_usage()/1024 << " Kb" << endl;
+  TiCC::Timer timer;
+  size_t found = 0;
+  timer.start();
+  for ( const auto& words : sentences ){
+    vector<UnicodeString> tags = tagger.create_ner_list( words );
+    for ( const auto& tag : tags ){
+      if ( tag != "O" ){
+	++found;
+      }
+    }
+  }
+  timer.stop();
+  cout << "looked up " << sentences.size() << " sentences, "
+       << word_cnt << " words, " << found << " words in a known NE" << endl;
+  cout << "gazetteer lookup took: " << timer << endl;
+}
 
 int main(int argc, char *argv[]) {
   std::ios_base::sync_with_stdio(false);
@@ -155,7 +210,7 @@ int main(int argc, char *argv[]) {
        << "Radboud University" << endl
        << "ILK   - Induction of Linguistic Knowledge Research Group,"
        << "Tilburg University" << endl;
-  TiCC::CL_Options Opts("Vt:d:hc:","version");
+  TiCC::CL_Options Opts("Vt:d:hc:","version,gazet-bench:,compile-gazetteer:,compile-override:");
   try {
     Opts.init(argc, argv);
   }
@@ -166,10 +221,27 @@ int main(int argc, char *argv[]) {
   cerr << "based on [" << Timbl::VersionName() << "]" << endl;
   cerr << "configdir: " << configDir << endl;
   if ( parse_args(Opts) ){
+    if ( !gazetImage.empty() || !overrideImage.empty() ){
+      // only compile, no need to initialize the tagger
+      if ( !gazetImage.empty()
+	   && !tagger.compile_gazets( configuration, "known_ners", gazetImage ) ){
+	return EXIT_FAILURE;
+      }
+      if ( !overrideImage.empty()
+	   && !tagger.compile_gazets( configuration, "ner_override", overrideImage ) ){
+	return EXIT_FAILURE;
+      }
+      return EXIT_SUCCESS;
+    }
     if (  !init() ){
       cerr << "terminated." << endl;
       return EXIT_FAILURE;
     }
+    if ( !benchFileName.empty() ){
+      ifstream in( benchFileName );
+      Bench( in );
+      return EXIT_SUCCESS;
+    }
     for ( const auto& TestFileName : fileNames ){
       ifstream in(TestFileName);
       if ( in.good() ){
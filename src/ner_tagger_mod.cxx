@@ -58,8 +58,6 @@ NERTagger::NERTagger( TiCC::LogStream *l, TiCC::LogStream *d ):
     \param l a LogStream for errors
     \param d a LogStream for debugging
   */
-  gazet_ners.resize( max_ner_size + 1 );
-  override_ners.resize( max_ner_size + 1 );
 }
 
 bool NERTagger::init( const TiCC::Configuration& config ){
@@ -105,7 +103,7 @@ bool NERTagger::init( const TiCC::Configuration& config ){
 bool NERTagger::fill_ners( const string& cat,
 			   const string& name,
 			   const string& config_dir,
-			   vector<map<UnicodeString,set<string>>>& ners ){
+			   Gazetteer& ners ){
   /// fill known Named Entities from one gazeteer file
   /*!
     \param cat The NE categorie (like 'loc' or 'org')
@@ -147,15 +145,11 @@ bool NERTagger::fill_ners( const string& cat,
 	  continue;
 	}
       }
-      // reconstruct the NER with single spaces
-      UnicodeString clean_line = "";
-      for ( const auto& part : parts ){
-	clean_line += part;
-	if ( &part != &parts.back() ){
-	  clean_line += " ";
-	}
+      if ( !ners.add( parts, cat ) ){
+	LOG << "too many different NE categories, unable to add: "
+	    << cat << endl;
+	return false;
       }
-      ners[parts.size()][clean_line].insert( cat );
       ++ner_cnt;
     }
   }
@@ -166,19 +160,19 @@ bool NERTagger::fill_ners( const string& cat,
 
 bool NERTagger::read_gazets( const string& name,
 			     const string& config_dir,
-			     vector<map<icu::UnicodeString,set<string>>>& ners ){
+			     Gazetteer& ners ){
   /// fill known Named Entities from a list of gazeteer files
   /*!
     \param name the filename to read the gazeteer info from
     \param config_dir the directory to search for files
     \param ners the structure to store the NE's in
 
-    NE's are stored in a vector of maps, ranked on their length. So NE's of
-    length 1 ("London") are stored at position 1 and so on. ("dag van de arbeid"
-    at position 4).
+    NE's are stored as token sequences in a Gazetteer trie. So "dag van de
+    arbeid" is stored as a path of 4 tokens, and the category is added to the
+    last node of that path. (as categories can be ambiguous)
 
-    the NE is stored in a map using as the mono-spaced string as key and adding
-    the cetagory in a set. (as categories can be ambiguous)
+    When 'name' is a Gazetteer image, made by compile_gazets(), it is used
+    as is.
   */
   string file_name = name;
   string lookup_dir = config_dir;
@@ -188,6 +182,15 @@ bool NERTagger::read_gazets( const string& name,
   else {
     lookup_dir = TiCC::dirname( file_name );
   }
+  if ( Gazetteer::is_image( file_name ) ){
+    if ( !ners.load( file_name ) ){
+      LOG << "invalid compiled Named Entities file " << file_name << endl;
+      return false;
+    }
+    LOG << "loaded " << ners.entries() << " compiled Named Entities from "
+	<< file_name << endl;
+    return true;
+  }
   ifstream is( file_name );
   if ( !is ){
     LOG << "Unable to find Named Enties file " << file_name << endl;
@@ -230,6 +233,45 @@ bool NERTagger::read_gazets( const string& name,
   }
 }
 
+bool NERTagger::compile_gazets( const TiCC::Configuration& config,
+				const string& key,
+				const string& image ){
+  /// compile the gazeteer files from the configuration into an image
+  /*!
+    \param config the configuration
+    \param key the configuration value with the list of gazeteer files. Like
+    'known_ners' or 'ner_override'
+    \param image the file to write the image to
+    \return true on succes
+
+    The image can be used instead of the original list in the configuration.
+    It is loaded without any parsing, see Gazetteer::load()
+  */
+  string val = config.lookUp( "max_ner_size", "NER" );
+  if ( !val.empty() ){
+    max_ner_size = TiCC::stringTo<int>( val );
+  }
+  val = config.lookUp( key, "NER" );
+  if ( val.empty() ){
+    LOG << "no '" << key << "' found in the NER configuration" << endl;
+    return false;
+  }
+  Gazetteer gaz;
+  if ( !read_gazets( val, config.configDir(), gaz ) ){
+    return false;
+  }
+  if ( gaz.is_mapped() ){
+    LOG << "'" << val << "' is already compiled" << endl;
+    return false;
+  }
+  if ( !gaz.save( image ) ){
+    LOG << "unable to write the Named Entities image: " << image << endl;
+    return false;
+  }
+  LOG << "wrote " << gaz.entries() << " Named Entities to: " << image << endl;
+  return true;
+}
+
 vector<UnicodeString> NERTagger::serialize( const vector<set<string>>& stags ) const {
   /// for every non empty set {el1,el2,..} in stags we compose a string like:
   /// el1+el2+...
@@ -249,40 +291,24 @@ vector<UnicodeString> NERTagger::serialize( const vector<set<string>>& stags ) c
 }
 
 vector<UnicodeString> NERTagger::create_ner_list( const vector<icu::UnicodeString>& words,
-						  const vector<map<icu::UnicodeString,set<string>>>& ners ){
+						  const Gazetteer& ners ) const {
   /// create a list of ambitags given a range of words
   /*!
     \param words a sentence as a list of words
     \param ners the NE structure to examine
    */
-  vector<set<string>> stags( words.size() );
+  if ( ners.empty() ){
+    return vector<UnicodeString>( words.size(), "O" );
+  }
   if ( debug > 1 ){
     DBG << "search for known NER's" << endl;
   }
-  for ( size_t j=0; j < words.size(); ++j ){
-    // cycle through the words
-    UnicodeString seq;
-    size_t len = 1;
-    for ( size_t i = 0; i < min( words.size() - j, (size_t)max_ner_size); ++i ){
-      // start looking for sequences of length len
-      auto const mp = ners[len++];
-      if ( mp.empty() ){
-	continue;
-      }
-      seq += words[j+i];
-      if ( debug > 1 ){
-	DBG << "sequence = '" << seq << "'" << endl;
-      }
-      auto const& tags = mp.find(seq);
-      if ( tags != mp.end() ){
-	if ( debug > 1 ){
-	  DBG << "FOUND tags " << tags->first << "-" << tags->second << endl;
-	}
-	for ( size_t k = 0; k <= i; ++k ){
-	  stags[k+j].insert( tags->second.begin(), tags->second.end() );
-	}
+  vector<set<string>> stags = ners.lookup( words );
+  if ( debug > 1 ){
+    for ( size_t i=0; i < words.size(); ++i ){
+      if ( !stags[i].empty() ){
+	DBG << "FOUND tags " << words[i] << "-" << stags[i] << endl;
       }
-      seq += " ";
     }
   }
   return serialize( stags );
@@ -312,14 +338,11 @@ void NERTagger::Classify( frog_data& swords ){
   }
   vector<UnicodeString> words;
   vector<UnicodeString> pos_tags;
-#pragma omp critical (dataupdate)
-  {
-    for ( const auto& w : swords.units ){
-      UnicodeString word = w.word;
-      word = filter_spaces( word );
-      words.push_back( word );
-      pos_tags.push_back( w.tag );
-    }
+  for ( const auto& w : swords.units ){
+    UnicodeString word = w.word;
+    word = filter_spaces( word );
+    words.push_back( word );
+    pos_tags.push_back( w.tag );
   }
   vector<tc_pair> ner_tags;
   if ( gazets_only ){
@@ -377,20 +400,20 @@ void NERTagger::Classify( frog_data& swords ){
       }
       to_do.push_back( entry );
     }
-    _tag_result = tag_entries( to_do );
+    vector<TagResult> tag_result = tag_entries( to_do );
     if ( debug > 1 ){
       DBG << "NER tagger out: " << endl;
-      for ( size_t i=0; i < _tag_result.size(); ++i ){
-	DBG << "[" << i << "] : word=" << _tag_result[i].word()
-	    << " tag=" << _tag_result[i].assigned_tag()
-	    << " confidence=" << _tag_result[i].confidence() << endl;
+      for ( size_t i=0; i < tag_result.size(); ++i ){
+	DBG << "[" << i << "] : word=" << tag_result[i].word()
+	    << " tag=" << tag_result[i].assigned_tag()
+	    << " confidence=" << tag_result[i].confidence() << endl;
       }
     }
     //
     // we have to correct for tags that start with 'I-'
     // (the MBT tagger may deliver those)
     UnicodeString last;
-    for ( const auto& tag : _tag_result ){
+    for ( const auto& tag : tag_result ){
       UnicodeString assigned = tag.assigned_tag();
       if ( assigned == "O" ){
 	last = "";
@@ -503,7 +526,8 @@ void NERTagger::addEntity( frog_data& sent,
 }
 
 
-void NERTagger::post_process( frog_data& ){
+void NERTagger::post_process( frog_data&,
+			      const vector<TagResult>& ){
   /// This implements BaseTagger::post_process by DISALLOWING it.
   throw logic_error( "NER tagger call undefined postprocess() member" );
 }
@@ -0,0 +1,1057 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+// compare the CKY parser and the parser's instance builders with the
+// straightforward implementations they replaced. Those are kept here as a
+// reference.
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "ticcutils/LogStream.h"
+#include "frog/ckyparser.h"
+#include "frog/Parser.h"
+
+using namespace std;
+using namespace icu;
+
+static int failures = 0;
+
+static void check( bool ok, const string& what ){
+  if ( !ok ){
+    cout << "FAILED: " << what << endl;
+    ++failures;
+  }
+}
+
+/// \brief a parse constraint as the old Constraint classes kept it, with the
+/// relation and the direction as strings
+struct reference_constraint {
+  enum kind_t { Incoming, Dependency, Direction };
+  kind_t kind;
+  int token;
+  int head;     ///< Dependency only
+  string rel;   ///< Dependency and Incoming only
+  string dir;   ///< Direction only
+  double weight;
+};
+
+static const char *relations[] = { "su", "obj1", "mod", "det", "hd", "vc",
+				   "body", "cnj", "crd", "predc", "pc", "ld" };
+static const char *directions[] = { "ROOT", "LEFT", "RIGHT" };
+
+static vector<reference_constraint> random_constraints( size_t len,
+							size_t span,
+							mt19937& gen ){
+  /// make constraints like formulateWCSP does, with random classifications
+  vector<reference_constraint> result;
+  auto weight = [&gen]{ return ( gen() % 10000 ) / 10000.0; };
+  for ( size_t d=1; d <= len; ++d ){
+    if ( gen() % 3 == 0 ){
+      result.push_back( { reference_constraint::Dependency, int(d), 0,
+			  relations[gen() % 12], "", weight() } );
+    }
+  }
+  for ( size_t d=1; d <= len; ++d ){
+    for ( size_t h=1; h <= len; ++h ){
+      size_t diff = ( h > d ) ? h - d : d - h;
+      if ( diff != 0 && diff <= span && gen() % 2 ){
+	result.push_back( { reference_constraint::Dependency, int(d), int(h),
+			    relations[gen() % 12], "", weight() } );
+      }
+    }
+  }
+  for ( size_t t=1; t <= len; ++t ){
+    int dirs = 1 + gen() % 3;
+    for ( int i=0; i < dirs; ++i ){
+      result.push_back( { reference_constraint::Direction, int(t), -1,
+			  "", directions[gen() % 3], weight() } );
+    }
+    int rels = 1 + gen() % 2;
+    for ( int i=0; i < rels; ++i ){
+      result.push_back( { reference_constraint::Incoming, int(1 + gen() % len),
+			  -1, relations[gen() % 12], "", weight() } );
+    }
+  }
+  return result;
+}
+
+static void fill_store( const vector<reference_constraint>& constraints,
+			ConstraintStore& store ){
+  /// add the constraints to a store, as formulateWCSP does
+  for ( const auto& c : constraints ){
+    switch ( c.kind ){
+    case reference_constraint::Dependency:
+      store.add_dependency( c.token, c.head, c.rel, c.weight );
+      break;
+    case reference_constraint::Incoming:
+      store.add_incoming( c.token, c.rel, c.weight );
+      break;
+    case reference_constraint::Direction:
+      store.add_direction( c.token, c.dir, c.weight );
+      break;
+    }
+  }
+}
+
+/// \brief the reference CKY decoder: Eisner's algorithm, keeping the
+/// satisfied constraints of every subtree in a set
+class reference_cky {
+ public:
+  reference_cky( size_t, const vector<reference_constraint>& );
+  void parse();
+  vector<parsrel> result();
+ private:
+  struct subtree {
+    double score = 0.0;
+    int r = -1;
+    string label;
+    set<const reference_constraint*> satisfied;
+  };
+  struct cell {
+    subtree l_True;
+    subtree l_False;
+    subtree r_True;
+    subtree r_False;
+  };
+  string bestEdge( const subtree&, const subtree&, size_t, size_t,
+		   set<const reference_constraint*>&, double& );
+  void leftIncomplete( int, int, vector<parsrel>& );
+  void rightIncomplete( int, int, vector<parsrel>& );
+  void leftComplete( int, int, vector<parsrel>& );
+  void rightComplete( int, int, vector<parsrel>& );
+  size_t numTokens;
+  vector<vector<const reference_constraint*>> inDep;
+  vector<vector<const reference_constraint*>> outDep;
+  vector<vector<vector<const reference_constraint*>>> edges;
+  vector<vector<cell>> chart;
+};
+
+reference_cky::reference_cky( size_t num,
+			      const vector<reference_constraint>& cs ):
+  numTokens( num )
+{
+  inDep.resize( numTokens + 1 );
+  outDep.resize( numTokens + 1 );
+  edges.assign( numTokens + 1,
+		vector<vector<const reference_constraint*>>( numTokens + 1 ) );
+  chart.assign( numTokens + 1, vector<cell>( numTokens + 1 ) );
+  for ( const auto& c : cs ){
+    switch ( c.kind ){
+    case reference_constraint::Incoming:
+      inDep[c.token].push_back( &c );
+      break;
+    case reference_constraint::Dependency:
+      edges[c.token][c.head].push_back( &c );
+      break;
+    case reference_constraint::Direction:
+      outDep[c.token].push_back( &c );
+      break;
+    }
+  }
+}
+
+string reference_cky::bestEdge( const subtree& left,
+				const subtree& right,
+				size_t headIndex,
+				size_t depIndex,
+				set<const reference_constraint*>& best,
+				double& bestScore ){
+  best.clear();
+  if ( headIndex == 0 ){
+    bestScore = 0.0;
+    for ( const auto& c : outDep[depIndex] ){
+      if ( c->dir == "ROOT" ){
+	bestScore = c->weight;
+	best.insert( c );
+      }
+    }
+    string label = "ROOT";
+    for ( const auto& c : edges[depIndex][0] ){
+      bestScore += c->weight;
+      best.insert( c );
+      label = c->rel;
+    }
+    return label;
+  }
+  bestScore = -0.5;
+  string bestLabel = "None";
+  for ( const auto& edge : edges[depIndex][headIndex] ){
+    double my_score = edge->weight;
+    string my_label = edge->rel;
+    set<const reference_constraint*> mine;
+    mine.insert( edge );
+    for ( const auto& c : inDep[headIndex] ){
+      if ( c->rel == my_label
+	   && left.satisfied.count( c ) == 0
+	   && right.satisfied.count( c ) == 0 ){
+	my_score += c->weight;
+	mine.insert( c );
+      }
+    }
+    for ( const auto& c : outDep[depIndex] ){
+      if ( ( ( c->dir == "LEFT" && headIndex < depIndex )
+	     || ( c->dir == "RIGHT" && headIndex > depIndex ) )
+	   && left.satisfied.count( c ) == 0
+	   && right.satisfied.count( c ) == 0 ){
+	my_score += c->weight;
+	mine.insert( c );
+      }
+    }
+    if ( my_score > bestScore ){
+      bestScore = my_score;
+      bestLabel = my_label;
+      best = std::move( mine );
+    }
+  }
+  return bestLabel;
+}
+
+static void merge( set<const reference_constraint*>& to,
+		   const set<const reference_constraint*>& from ){
+  to.insert( from.begin(), from.end() );
+}
+
+void reference_cky::parse(){
+  for ( size_t k=1; k < numTokens + 2; ++k ){
+    for ( size_t s=0; s < numTokens + 1 - k; ++s ){
+      size_t t = s + k;
+      for ( int step=1; step <= 2; ++step ){
+	double bestScore = -10E45;
+	int bestI = -1;
+	string bestL = "__";
+	set<const reference_constraint*> bestConstraints;
+	for ( size_t r = s; r < t; ++r ){
+	  double edgeScore = -0.5;
+	  set<const reference_constraint*> constraints;
+	  string label = ( step == 1 )
+	    ? bestEdge( chart[s][r].r_True, chart[r+1][t].l_True,
+			t, s, constraints, edgeScore )
+	    : bestEdge( chart[s][r].r_True, chart[r+1][t].l_True,
+			s, t, constraints, edgeScore );
+	  double score = chart[s][r].r_True.score
+	    + chart[r+1][t].l_True.score + edgeScore;
+	  if ( score > bestScore ){
+	    bestScore = score;
+	    bestI = r;
+	    bestL = label;
+	    bestConstraints = std::move( constraints );
+	  }
+	}
+	subtree& st = ( step == 1 ) ? chart[s][t].l_False : chart[s][t].r_False;
+	st.score = bestScore;
+	st.r = bestI;
+	st.label = bestL;
+	st.satisfied.clear();
+	merge( st.satisfied, chart[s][bestI].r_True.satisfied );
+	merge( st.satisfied, chart[bestI+1][t].l_True.satisfied );
+	merge( st.satisfied, bestConstraints );
+      }
+      double bestScore = -10E45;
+      int bestI = -1;
+      for ( size_t r = s; r < t; ++r ){
+	double score = chart[s][r].l_True.score + chart[r][t].l_False.score;
+	if ( score > bestScore ){
+	  bestScore = score;
+	  bestI = r;
+	}
+      }
+      subtree& lt = chart[s][t].l_True;
+      lt.score = bestScore;
+      lt.r = bestI;
+      merge( lt.satisfied, chart[s][bestI].l_True.satisfied );
+      merge( lt.satisfied, chart[bestI][t].l_False.satisfied );
+      bestScore = -10E45;
+      bestI = -1;
+      for ( size_t r = s+1; r < t+1; ++r ){
+	double score = chart[s][r].r_False.score + chart[r][t].r_True.score;
+	if ( score > bestScore ){
+	  bestScore = score;
+	  bestI = r;
+	}
+      }
+      subtree& rt = chart[s][t].r_True;
+      rt.score = bestScore;
+      rt.r = bestI;
+      merge( rt.satisfied, chart[s][bestI].r_False.satisfied );
+      merge( rt.satisfied, chart[bestI][t].r_True.satisfied );
+    }
+  }
+}
+
+void reference_cky::leftIncomplete( int s, int t, vector<parsrel>& pr ){
+  int r = chart[s][t].l_False.r;
+  if ( r >= 0 ){
+    pr[s - 1].deprel = chart[s][t].l_False.label;
+    pr[s - 1].head = t;
+    rightComplete( s, r, pr );
+    leftComplete( r + 1, t, pr );
+  }
+}
+
+void reference_cky::rightIncomplete( int s, int t, vector<parsrel>& pr ){
+  int r = chart[s][t].r_False.r;
+  if ( r >= 0 ){
+    pr[t - 1].deprel = chart[s][t].r_False.label;
+    pr[t - 1].head = s;
+    rightComplete( s, r, pr );
+    leftComplete( r + 1, t, pr );
+  }
+}
+
+void reference_cky::leftComplete( int s, int t, vector<parsrel>& pr ){
+  int r = chart[s][t].l_True.r;
+  if ( r >= 0 ){
+    leftComplete( s, r, pr );
+    leftIncomplete( r, t, pr );
+  }
+}
+
+void reference_cky::rightComplete( int s, int t, vector<parsrel>& pr ){
+  int r = chart[s][t].r_True.r;
+  if ( r >= 0 ){
+    rightIncomplete( s, r, pr );
+    rightComplete( r, t, pr );
+  }
+}
+
+vector<parsrel> reference_cky::result(){
+  vector<parsrel> pr( numTokens );
+  rightComplete( 0, numTokens, pr );
+  return pr;
+}
+
+
+static bool same_tree( const vector<parsrel>& a, const vector<parsrel>& b ){
+  if ( a.size() != b.size() ){
+    return false;
+  }
+  for ( size_t i=0; i < a.size(); ++i ){
+    if ( a[i].head != b[i].head || a[i].deprel != b[i].deprel ){
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool has_long_edge( const vector<parsrel>& tree, size_t span ){
+  for ( size_t i=0; i < tree.size(); ++i ){
+    int dist = abs( tree[i].head - int(i+1) );
+    if ( tree[i].head != 0 && size_t(dist) > span ){
+      return true;
+    }
+  }
+  return false;
+}
+
+static void test_cky(){
+  TiCC::LogStream log;
+  mt19937 gen( 4711 );
+  const size_t span = 8;
+  size_t bounded_checked = 0;
+  for ( size_t len=1; len <= 70; ++len ){
+    for ( int rep=0; rep < 3; ++rep ){
+      vector<reference_constraint> constraints
+	= random_constraints( len, span, gen );
+      ConstraintStore store( constraints.size() );
+      fill_store( constraints, store );
+      reference_cky ref( len, constraints );
+      ref.parse();
+      vector<parsrel> expected = ref.result();
+      string what = "sentence of " + to_string( len ) + " tokens";
+      vector<parsrel> result( len );
+      CKYParser plain( len, store, &log );
+      plain.parse();
+      plain.rightComplete( 0, len, result );
+      check( same_tree( expected, result ), "CKY " + what );
+      result.assign( len, parsrel() );
+      CKYParser parallel( len, store, &log );
+      parallel.parse( 4 );
+      parallel.rightComplete( 0, len, result );
+      check( same_tree( expected, result ), "parallel CKY " + what );
+      result.assign( len, parsrel() );
+      CKYParser bounded( len, store, &log, span );
+      bounded.parse();
+      bounded.rightComplete( 0, len, result );
+      check( !has_long_edge( result, span ),
+	     "bounded CKY has no long edges, " + what );
+      if ( !has_long_edge( expected, span ) ){
+	// only then the bounded decoding is exact
+	check( same_tree( expected, result ), "bounded CKY " + what );
+	++bounded_checked;
+      }
+    }
+  }
+  check( bounded_checked > 100, "enough bounded sentences compared" );
+}
+
+static const char *direction_name( dirType dir ){
+  switch ( dir ){
+  case ROOT:
+    return "ROOT";
+  case LEFT:
+    return "LEFT";
+  case RIGHT:
+    return "RIGHT";
+  default:
+    return "ERROR";
+  }
+}
+
+static void test_store(){
+  ConstraintStore fixed;
+  check( fixed.relation( ConstraintStore::NONE_LABEL ) == "None"
+	 && fixed.relation( ConstraintStore::ROOT_LABEL ) == "ROOT"
+	 && fixed.relation( ConstraintStore::UNSET_LABEL ) == "__"
+	 && fixed.relation( ConstraintStore::EMPTY_LABEL ) == "",
+	 "the fixed labels have their fixed ids" );
+  mt19937 gen( 1234 );
+  for ( size_t len=1; len <= 40; ++len ){
+    vector<reference_constraint> constraints = random_constraints( len, 8, gen );
+    ConstraintStore store( constraints.size() );
+    fill_store( constraints, store );
+    string what = " of a sentence of " + to_string( len ) + " tokens";
+    check( store.size() == constraints.size(),
+	   "the store holds all constraints" + what );
+    map<string,int> ids;
+    bool same = true;
+    auto it = store.begin();
+    for ( const auto& ref : constraints ){
+      const wcsp_constraint& c = *it++;
+      same = same && c.token == ref.token && c.weight == ref.weight;
+      switch ( ref.kind ){
+      case reference_constraint::Dependency:
+	same = same && c.type == wcsp_constraint::Dependency
+	  && c.head == ref.head && store.relation( c.rel ) == ref.rel;
+	break;
+      case reference_constraint::Incoming:
+	same = same && c.type == wcsp_constraint::Incoming
+	  && store.relation( c.rel ) == ref.rel;
+	break;
+      case reference_constraint::Direction:
+	same = same && c.type == wcsp_constraint::Direction
+	  && ref.dir == direction_name( c.direction );
+	break;
+      }
+      if ( ref.kind != reference_constraint::Direction ){
+	// a relation always gets the same id
+	auto ins = ids.insert( make_pair( ref.rel, c.rel ) );
+	same = same && ins.first->second == c.rel;
+      }
+    }
+    check( same, "the store gives back the constraints" + what );
+    check( store.relations() == int( 4 + ids.size() ),
+	   "every relation is interned once" + what );
+  }
+}
+
+static vector<UnicodeString> reference_pairs( const parseData& pd,
+					      size_t maxDepSpan ){
+  /// the old createPairInstances(), verbatim
+  vector<UnicodeString> instances;
+  const vector<UnicodeString>& words = pd.words;
+  const vector<UnicodeString>& heads = pd.heads;
+  const vector<UnicodeString>& mods = pd.mods;
+  if ( words.size() == 1 ){
+    UnicodeString inst =
+      "__ " + words[0] + " __ ROOT ROOT ROOT __ " + heads[0]
+      + " __ ROOT ROOT ROOT "+ words[0] +"^ROOT ROOT ROOT ROOT^"
+      + heads[0] + " _";
+    instances.push_back( inst );
+  }
+  else {
+    for ( size_t i=0 ; i < words.size(); ++i ){
+      UnicodeString word_1, word0, word1;
+      UnicodeString tag_1, tag0, tag1;
+      UnicodeString mods0;
+      if ( i == 0 ){
+	word_1 = "__";
+	tag_1 = "__";
+      }
+      else {
+	word_1 = words[i-1];
+	tag_1 = heads[i-1];
+      }
+      word0 = words[i];
+      tag0 = heads[i];
+      mods0 = mods[i];
+      if ( i == words.size() - 1 ){
+	word1 = "__";
+	tag1 = "__";
+      }
+      else {
+	word1 = words[i+1];
+	tag1 = heads[i+1];
+      }
+      UnicodeString inst = word_1 + " " + word0 + " " + word1
+	+ " ROOT ROOT ROOT " + tag_1 + " "
+	+ tag0 + " " + tag1 + " ROOT ROOT ROOT " + tag0
+	+ "^ROOT ROOT ROOT ROOT^" + mods0 + " _";
+      instances.push_back( inst );
+    }
+    //
+    for ( size_t wPos=0; wPos < words.size(); ++wPos ){
+      UnicodeString w_word_1, w_word0, w_word1;
+      UnicodeString w_tag_1, w_tag0, w_tag1;
+      UnicodeString w_mods0;
+      if ( wPos == 0 ){
+	w_word_1 = "__";
+	w_tag_1 = "__";
+      }
+      else {
+	w_word_1 = words[wPos-1];
+	w_tag_1 = heads[wPos-1];
+      }
+      w_word0 = words[wPos];
+      w_tag0 = heads[wPos];
+      w_mods0 = mods[wPos];
+      if ( wPos == words.size()-1 ){
+	w_word1 = "__";
+	w_tag1 = "__";
+      }
+      else {
+	w_word1 = words[wPos+1];
+	w_tag1 = heads[wPos+1];
+      }
+      for ( size_t pos=0; pos < words.size(); ++pos ){
+	if ( pos > wPos + maxDepSpan ){
+	  break;
+	}
+	if ( pos == wPos ){
+	  continue;
+	}
+	if ( pos + maxDepSpan < wPos ){
+	  continue;
+	}
+	UnicodeString inst = w_word_1 + " " + w_word0 + " " + w_word1;
+
+	if ( pos == 0 ){
+	  inst += " __";
+	}
+	else {
+	  inst += " " + words[pos-1];
+	}
+	if ( pos < words.size() ){
+	  inst += " " + words[pos];
+	}
+	else {
+	  inst += " __";
+	}
+	if ( pos < words.size()-1 ){
+	  inst += " " + words[pos+1];
+	}
+	else {
+	  inst += " __";
+	}
+	inst += " " + w_tag_1 + " " + w_tag0 + " " + w_tag1;
+	if ( pos == 0 ){
+	  inst += " __";
+	}
+	else {
+	  inst += " " + heads[pos-1];
+	}
+	if ( pos < words.size() ){
+	  inst += " " + heads[pos];
+	}
+	else {
+	  inst += " __";
+	}
+	if ( pos < words.size()-1 ){
+	  inst += " " + heads[pos+1];
+	}
+	else {
+	  inst += " __";
+	}
+
+	inst += " " + w_tag0 + "^";
+	if ( pos < words.size() ){
+	  inst += heads[pos];
+	}
+	else {
+	  inst += "__";
+	}
+
+	if ( wPos > pos ){
+	  inst += " LEFT " + TiCC::toUnicodeString( wPos - pos );
+	}
+	else {
+	  inst += " RIGHT "+ TiCC::toUnicodeString( pos - wPos );
+	}
+	if ( pos >= words.size() ){
+	  inst += " __";
+	}
+	else {
+	  inst += " " + mods[pos];
+	}
+	inst += "^" + w_mods0 + " __";
+	instances.push_back( inst );
+      }
+    }
+  }
+  return instances;
+}
+
+static vector<UnicodeString> reference_dirs( const parseData& pd ){
+  /// the old createDirInstances(), verbatim
+  vector<UnicodeString> d_instances;
+  const vector<UnicodeString>& words = pd.words;
+  const vector<UnicodeString>& heads = pd.heads;
+  const vector<UnicodeString>& mods = pd.mods;
+
+  if ( words.size() == 1 ){
+    UnicodeString word0 = words[0];
+    UnicodeString tag0 = heads[0];
+    UnicodeString mod0 = mods[0];
+    UnicodeString inst = "__ __ " + word0 + " __ __ __ __ " + tag0
+      + " __ __ __ __ " + word0 + "^" + tag0
+      + " __ __ __^" + tag0 + " " + tag0 +"^__ __ " + mod0
+      + " __ ROOT";
+    d_instances.push_back( inst );
+  }
+  else if ( words.size() == 2 ){
+    UnicodeString word0 = words[0];
+    UnicodeString tag0 = heads[0];
+    UnicodeString mod0 = mods[0];
+    UnicodeString word1 = words[1];
+    UnicodeString tag1 = heads[1];
+    UnicodeString mod1 = mods[1];
+    UnicodeString inst = UnicodeString("__ __")
+      + " " + word0
+      + " " + word1
+      + " __ __ __"
+      + " " + tag0
+      + " " + tag1
+      + " __ __ __"
+      + " " + word0 + "^" + tag0
+      + " " + word1 + "^" + tag1
+      + " __ __^" + tag0
+      + " " + tag0 + "^" + tag1
+      + " __"
+      + " " + mod0
+      + " " + mod1
+      + " ROOT";
+    d_instances.push_back( inst );
+    inst = UnicodeString("__")
+      + " " + word0
+      + " " + word1
+      + " __ __ __"
+      + " " + tag0
+      + " " + tag1
+      + " __ __ __"
+      + " " + word0 + "^" + tag0
+      + " " + word1 + "^" + tag1
+      + " __ __"
+      + " " + tag0 + "^" + tag1
+      + " " + tag1 + "^__"
+      + " " + mod0
+      + " " + mod1
+      + " __"
+      + " ROOT";
+    d_instances.push_back( inst );
+  }
+  else if ( words.size() == 3 ) {
+    UnicodeString word0 = words[0];
+    UnicodeString tag0 = heads[0];
+    UnicodeString mod0 = mods[0];
+    UnicodeString word1 = words[1];
+    UnicodeString tag1 = heads[1];
+    UnicodeString mod1 = mods[1];
+    UnicodeString word2 = words[2];
+    UnicodeString tag2 = heads[2];
+    UnicodeString mod2 = mods[2];
+    UnicodeString inst = UnicodeString("__ __")
+      + " " + word0
+      + " " + word1
+      + " " + word2
+      + " __ __"
+      + " " + tag0
+      + " " + tag1
+      + " " + tag2
+      + " __ __"
+      + " " + word0 + "^" + tag0
+      + " " + word1 + "^" + tag1
+      + " " + word2 + "^" + tag2
+      + " __^" + tag0
+      + " " + tag0 + "^" + tag1
+      + " __"
+      + " " + mod0
+      + " " + mod1
+      + " ROOT";
+    d_instances.push_back( inst );
+    inst = UnicodeString("__")
+      + " " + word0
+      + " " + word1
+      + " " + word2
+      + " __ __"
+      + " " + tag0
+      + " " + tag1
+      + " " + tag2
+      + " __ __"
+      + " " + word0 + "^" + tag0
+      + " " + word1 + "^" + tag1
+      + " " + word2 + "^" + tag2
+      + " __"
+      + " " + tag0 + "^" + tag1
+      + " " + tag1 + "^" + tag2
+      + " " + mod0
+      + " " + mod1
+      + " " + mod2
+      + " ROOT";
+    d_instances.push_back( inst );
+    inst = word0
+      + " " + word1
+      + " " + word2
+      + " __ __"
+      + " " + tag0
+      + " " + tag1
+      + " " + tag2
+      + " __ __"
+      + " " + word0 + "^" + tag0
+      + " " + word1 + "^" + tag1
+      + " " + word2 + "^" + tag2
+      + " __ __"
+      + " " + tag1 + "^" + tag2
+      + " " + tag2 + "^__"
+      + " " + mod1
+      + " " + mod2
+      + " __"
+      + " ROOT";
+    d_instances.push_back( inst );
+  }
+  else {
+    for ( size_t i=0 ; i < words.size(); ++i ){
+      UnicodeString word_1, word_2;
+      UnicodeString tag_1, tag_2;
+      UnicodeString mod_1;
+      if ( i == 0 ){
+	word_2 = "__";
+	tag_2 = "__";
+	//	mod_2 = "__";
+	word_1 = "__";
+	tag_1 = "__";
+	mod_1 = "__";
+      }
+      else if ( i == 1 ){
+	word_2 = "__";
+	tag_2 = "__";
+	//	mod_2 = "__";
+	word_1 = words[i-1];
+	tag_1 = heads[i-1];
+	mod_1 = mods[i-1];
+      }
+      else {
+	word_2 = words[i-2];
+	tag_2 = heads[i-2];
+	//	mod_2 = mods[i-2];
+	word_1 = words[i-1];
+	tag_1 = heads[i-1];
+	mod_1 = mods[i-1];
+      }
+      UnicodeString word0 = words[i];
+      UnicodeString word1, word2;
+      UnicodeString tag0 = heads[i];
+      UnicodeString tag1, tag2;
+      UnicodeString mod0 = mods[i];
+      UnicodeString mod1;
+      if ( i < words.size() - 2 ){
+	word1 = words[i+1];
+	tag1 = heads[i+1];
+	mod1 = mods[i+1];
+	word2 = words[i+2];
+	tag2 = heads[i+2];
+	//	mod2 = mods[i+2];
+      }
+      else if ( i == words.size() - 2 ){
+	word1 = words[i+1];
+	tag1 = heads[i+1];
+	mod1 = mods[i+1];
+	word2 = "__";
+	tag2 = "__";
+	//	mod2 = "__";
+      }
+      else {
+	word1 = "__";
+	tag1 = "__";
+	mod1 = "__";
+	word2 = "__";
+	tag2 = "__";
+	//	mod2 = "__";
+      }
+      UnicodeString inst = word_2
+	+ " " + word_1
+	+ " " + word0
+	+ " " + word1
+	+ " " + word2
+	+ " " + tag_2
+	+ " " + tag_1
+	+ " " + tag0
+	+ " " + tag1
+	+ " " + tag2
+	+ " " + word_2 + "^" + tag_2
+	+ " " + word_1 + "^" + tag_1
+	+ " " + word0 + "^" + tag0
+	+ " " + word1 + "^" + tag1
+	+ " " + word2 + "^" + tag2
+	+ " " + tag_1 + "^" + tag0
+	+ " " + tag0 + "^" + tag1
+	+ " " + mod_1
+	+ " " + mod0
+	+ " " + mod1
+	+ " ROOT";
+      d_instances.push_back( inst );
+    }
+  }
+  return d_instances;
+}
+
+static vector<UnicodeString> reference_rels( const parseData& pd ){
+  /// the old createRelInstances(), verbatim
+  vector<UnicodeString> r_instances;
+  const vector<UnicodeString>& words = pd.words;
+  const vector<UnicodeString>& heads = pd.heads;
+  const vector<UnicodeString>& mods = pd.mods;
+
+  if ( words.size() == 1 ){
+    UnicodeString word0 = words[0];
+    UnicodeString tag0 = heads[0];
+    UnicodeString mod0 = mods[0];
+    UnicodeString inst = "__ __ " + word0 + " __ __ " + mod0
+      + " __ __ "  + tag0 + " __ __ __^" + tag0
+      + " " + tag0 + "^__ __^__^" + tag0
+      + " " + tag0 + "^__^__ __";
+    r_instances.push_back( inst );
+  }
+  else if ( words.size() == 2 ){
+    UnicodeString word0 = words[0];
+    UnicodeString tag0 = heads[0];
+    UnicodeString mod0 = mods[0];
+    UnicodeString word1 = words[1];
+    UnicodeString tag1 = heads[1];
+    UnicodeString mod1 = mods[1];
+    //
+    UnicodeString inst = UnicodeString("__ __")
+      + " " + word0
+      + " " + word1
+      + " __"
+      + " " + mod0
+      + " __ __"
+      + " " + tag0
+      + " " + tag1
+      + " __"
+      + " __^" + tag0
+      + " " + tag0 + "^" + tag1
+      + " __^__^" + tag0
+      + " " + tag0 + "^" + tag1 + "^__"
+      + " __";
+    r_instances.push_back( inst );
+    inst = UnicodeString("__")
+      + " " + word0
+      + " " + word1
+      + " __ __"
+      + " " + mod1
+      + " __"
+      + " " + tag0
+      + " " + tag1
+      + " __ __"
+      + " " + tag0 + "^" + tag1
+      + " " + tag1 + "^__"
+      + " __^" + tag0 + "^" + tag1
+      + " " + tag1 + "^__^__"
+      + " __";
+    r_instances.push_back( inst );
+  }
+  else if ( words.size() == 3 ) {
+    UnicodeString word0 = words[0];
+    UnicodeString tag0 = heads[0];
+    UnicodeString mod0 = mods[0];
+    UnicodeString word1 = words[1];
+    UnicodeString tag1 = heads[1];
+    UnicodeString mod1 = mods[1];
+    UnicodeString word2 = words[2];
+    UnicodeString tag2 = heads[2];
+    UnicodeString mod2 = mods[2];
+    //
+    UnicodeString inst = UnicodeString("__ __")
+      + " " + word0
+      + " " + word1
+      + " " + word2
+      + " " + mod0
+      + " __ __"
+      + " " + tag0
+      + " " + tag1
+      + " " + tag2
+      + " __^" + tag0
+      + " " + tag0 + "^" + tag1
+      + " __^__^" + tag0
+      + " " + tag0 + "^" + tag1 + "^" + tag2
+      + " __";
+    r_instances.push_back( inst );
+    inst = UnicodeString("__")
+      + " " + word0
+      + " " + word1
+      + " " + word2
+      + " __"
+      + " " + mod1
+      + " __"
+      + " " + tag0
+      + " " + tag1
+      + " " + tag2
+      + " __"
+      + " " + tag0 + "^" + tag1
+      + " " + tag1 + "^" + tag2
+      + " __^" + tag0 + "^" + tag1
+      + " " + tag1 + "^" + tag2 + "^__"
+      + " __";
+    r_instances.push_back( inst );
+    inst = word0
+      + " " + word1
+      + " " + word2
+      + " __ __"
+      + " " + mod2
+      + " " + tag0
+      + " " + tag1
+      + " " + tag2
+      + " __ __"
+      + " " + tag1 + "^" + tag2
+      + " " + tag2 + "^__"
+      + " " + tag0 + "^" + tag1 + "^" + tag2
+      + " " + tag2 + "^__^__"
+      + " __";
+    r_instances.push_back( inst );
+  }
+  else {
+    for ( size_t i=0 ; i < words.size(); ++i ){
+      UnicodeString word_1, word_2;
+      UnicodeString tag_1, tag_2;
+      if ( i == 0 ){
+	word_2 = "__";
+	tag_2 = "__";
+	word_1 = "__";
+	tag_1 = "__";
+      }
+      else if ( i == 1 ){
+	word_2 = "__";
+	tag_2 = "__";
+	word_1 = words[i-1];
+	tag_1 = heads[i-1];
+      }
+      else {
+	word_2 = words[i-2];
+	tag_2 = heads[i-2];
+	word_1 = words[i-1];
+	tag_1 = heads[i-1];
+      }
+      UnicodeString word0 = words[i];
+      UnicodeString word1, word2;
+      UnicodeString tag0 = heads[i];
+      UnicodeString tag1, tag2;
+      UnicodeString mod0 = mods[i];
+      if ( i < words.size() - 2 ){
+	word1 = words[i+1];
+	tag1 = heads[i+1];
+	word2 = words[i+2];
+	tag2 = heads[i+2];
+      }
+      else if ( i == words.size() - 2 ){
+	word1 = words[i+1];
+	tag1 = heads[i+1];
+	word2 = "__";
+	tag2 = "__";
+      }
+      else {
+	word1 = "__";
+	tag1 = "__";
+	word2 = "__";
+	tag2 = "__";
+      }
+      //
+      UnicodeString inst = word_2
+	+ " " + word_1
+	+ " " + word0
+	+ " " + word1
+	+ " " + word2
+	+ " " + mod0
+	+ " " + tag_2
+	+ " " + tag_1
+	+ " " + tag0
+	+ " " + tag1
+	+ " " + tag2
+	+ " " + tag_1 + "^" + tag0
+	+ " " + tag0 + "^" + tag1
+	+ " " + tag_2 + "^" + tag_1 + "^" + tag0
+	+ " " + tag0 + "^" + tag1 + "^" + tag2
+	+ " __";
+      r_instances.push_back( inst );
+    }
+  }
+  return r_instances;
+}
+
+static void test_instances(){
+  mt19937 gen( 42 );
+  const char *values[] = { "de", "kat", "zit", "op", "mat", "WW", "N",
+			   "ADJ", "pv|tgw|met-t", "a_b", "__" };
+  for ( size_t len=1; len < 60; ++len ){
+    for ( int rep=0; rep < 3; ++rep ){
+      parseData pd;
+      for ( size_t i=0; i < len; ++i ){
+	pd.words.push_back( values[gen() % 11] );
+	pd.heads.push_back( values[gen() % 11] );
+	pd.mods.push_back( values[gen() % 11] );
+      }
+      size_t maxDepSpan = 1 + gen() % 25;
+      string what = " of a sentence of " + to_string( len ) + " tokens";
+      check( createPairInstances( pd, maxDepSpan )
+	     == reference_pairs( pd, maxDepSpan ), "pair instances" + what );
+      check( createDirInstances( pd ) == reference_dirs( pd ),
+	     "dir instances" + what );
+      check( createRelInstances( pd ) == reference_rels( pd ),
+	     "rel instances" + what );
+    }
+  }
+}
+
+int main(){
+  test_cky();
+  test_store();
+  test_instances();
+  if ( failures == 0 ){
+    cout << "all parser tests passed" << endl;
+    return EXIT_SUCCESS;
+  }
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,175 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+#include "frog/sentence_pipeline.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+SentencePipeline::SentencePipeline( size_t num_workers,
+				    size_t max_pending,
+				    const work_fun& fun ):
+  _work( fun ),
+  capacity( max_pending ),
+  stopping( false )
+{
+  /// create a pipeline and start the worker threads
+  /*!
+    \param num_workers the number of worker threads to start (at least 1)
+    \param max_pending the maximum number of sentences that may be in
+    the pipeline at any moment. submit() blocks when this limit is reached.
+    \param fun the function the workers apply to every sentence
+  */
+  if ( num_workers < 1 ){
+    num_workers = 1;
+  }
+  if ( capacity < num_workers ){
+    capacity = num_workers;
+  }
+  threads.reserve( num_workers );
+  for ( size_t i=0; i < num_workers; ++i ){
+    threads.emplace_back( &SentencePipeline::work, this, i );
+  }
+}
+
+SentencePipeline::~SentencePipeline(){
+  /// stop and join all workers. Undelivered sentences are discarded
+  {
+    lock_guard<mutex> guard( lock );
+    stopping = true;
+  }
+  todo_cond.notify_all();
+  for ( auto& t : threads ){
+    t.join();
+  }
+  for ( const auto *j : pending ){
+    delete j;
+  }
+}
+
+void SentencePipeline::work( size_t id ){
+  /// the main loop of worker \e id
+  while ( true ){
+    job *j = 0;
+    {
+      unique_lock<mutex> l( lock );
+      todo_cond.wait( l, [this]{ return stopping || !todo.empty(); } );
+      if ( stopping ){
+	return;
+      }
+      j = todo.front();
+      todo.pop_front();
+    }
+    try {
+      _work( j->sentence, j->s_count, id );
+    }
+    catch ( ... ){
+      j->error = current_exception();
+    }
+    {
+      lock_guard<mutex> guard( lock );
+      j->ready = true;
+    }
+    done_cond.notify_all();
+  }
+}
+
+bool SentencePipeline::deliver( unique_lock<mutex>& l ){
+  /// run the 'done' functions of all finished sentences at the front of
+  /// the queue
+  /*!
+    \param l the lock on the queues, which must be held by the caller
+    \return true when at least one sentence was delivered
+
+    The lock is released while the 'done' functions run, so the workers can
+    continue meanwhile. When frogging a sentence failed, the exception is
+    rethrown here, on the producer thread.
+  */
+  bool result = false;
+  while ( !pending.empty() && pending.front()->ready ){
+    job *j = pending.front();
+    pending.pop_front();
+    l.unlock();
+    result = true;
+    if ( j->error ){
+      exception_ptr err = j->error;
+      delete j;
+      rethrow_exception( err );
+    }
+    try {
+      j->done( j->sentence );
+    }
+    catch ( ... ){
+      delete j;
+      throw;
+    }
+    delete j;
+    l.lock();
+  }
+  return result;
+}
+
+void SentencePipeline::submit( frog_data&& sentence,
+			       size_t s_count,
+			       const done_fun& done ){
+  /// add a sentence to the pipeline
+  /*!
+    \param sentence the (tokenized) sentence to frog. It is moved into
+    the pipeline
+    \param s_count the sentence number, for diagnostics
+    \param done the function to call with the frogged sentence.
+
+    When the pipeline is full, this will block until the oldest sentence
+    is frogged. Meanwhile finished sentences are delivered.
+  */
+  unique_lock<mutex> l( lock );
+  while ( pending.size() >= capacity ){
+    if ( !deliver( l ) ){
+      done_cond.wait( l );
+    }
+  }
+  job *j = new job( std::move(sentence), s_count, done );
+  pending.push_back( j );
+  todo.push_back( j );
+  todo_cond.notify_one();
+  deliver( l );
+}
+
+void SentencePipeline::flush(){
+  /// wait until all submitted sentences are frogged AND delivered
+  unique_lock<mutex> l( lock );
+  while ( !pending.empty() ){
+    if ( !deliver( l ) ){
+      done_cond.wait( l );
+    }
+  }
+}
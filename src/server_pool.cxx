@@ -0,0 +1,215 @@
+/* ex: set tabstop=8 expandtab: */
+/*
+  Copyright (c) 2006 - 2026
+  CLST  - Radboud University
+  ILK   - Tilburg University
+
+  This file is part of frog:
+
+  A Tagger-Lemmatizer-Morphological-Analyzer-Dependency-Parser for
+  several languages
+
+  frog is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 3 of the License, or
+  (at your option) any later version.
+
+  frog is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+  For questions and suggestions, see:
+      https://github.com/LanguageMachines/frog/issues
+  or send mail to:
+      lamasoftware (at ) science.ru.nl
+
+*/
+
+
+#include "frog/server_pool.h"
+
+#include <unistd.h>
+#include <stdexcept>
+
+using namespace std;
+using namespace nlohmann;
+
+shared_ptr<ServerPool> ServerPool::get( const string& host,
+					const string& port,
+					const string& base ){
+  /// return the pool for host:port:base, create it when needed
+  /*!
+    \param host the host of the server
+    \param port the port of the server
+    \param base the base to select on the server. May be empty
+    \return the pool.
+  */
+  static mutex registry_lock;
+  static map<string,shared_ptr<ServerPool>> registry;
+  string key = host + ":" + port + ":" + base;
+  lock_guard<mutex> guard( registry_lock );
+  auto& pool = registry[key];
+  if ( !pool ){
+    pool.reset( new ServerPool( host, port, base ) );
+  }
+  return pool;
+}
+
+ServerPool::ServerPool( const string& host,
+			const string& port,
+			const string& base ):
+  _host( host ),
+  _port( port ),
+  _base( base ),
+  owner( getpid() ),
+  _connects( 0 )
+{
+}
+
+json ServerPool::parse( const string& line ) const {
+  /// parse a JSON line from the server
+  /*!
+    \param line the received line
+    \return the parsed json
+    throws on invalid JSON, or when the server returned an error status
+  */
+  json result;
+  try {
+    result = json::parse( line );
+  }
+  catch ( const exception& e ){
+    throw runtime_error( "json parsing failed on '" + line + "' from "
+			 + name() + ":" + e.what() );
+  }
+  if ( result.is_object()
+       && result.find( "status" ) != result.end()
+       && result["status"] != "ok" ){
+    throw runtime_error( "the server at " + name() + " isn't OK: "
+			 + line );
+  }
+  return result;
+}
+
+ServerPool::connection ServerPool::connect(){
+  /// open a new connection, read the greeting and select the base
+  /*!
+    \return the connection. Throws when the server can not be reached
+  */
+  connection client( new Sockets::ClientSocket() );
+  if ( !client->connect( _host, _port ) ){
+    throw runtime_error( "failed to open connection, " + name()
+			 + "\nReason: " + client->getMessage() );
+  }
+  string line;
+  if ( !client->read( line ) ){
+    throw runtime_error( "no greeting from " + name() );
+  }
+  parse( line );
+  if ( !_base.empty() ){
+    json out_json;
+    out_json["command"] = "base";
+    out_json["param"] = _base;
+    if ( !client->write( out_json.dump() + "\n" )
+	 || !client->read( line ) ){
+      throw runtime_error( "unable to select base " + _base
+			   + " on " + name() );
+    }
+    parse( line );
+  }
+  lock_guard<mutex> guard( pool_lock );
+  ++_connects;
+  return client;
+}
+
+ServerPool::connection ServerPool::acquire(){
+  /// take an idle connection from the pool, or open a new one
+  {
+    lock_guard<mutex> guard( pool_lock );
+    if ( owner != getpid() ){
+      // we are a forked child. Never share the sockets of our parent
+      idle.clear();
+      owner = getpid();
+    }
+    if ( !idle.empty() ){
+      connection result = std::move( idle.back() );
+      idle.pop_back();
+      return result;
+    }
+  }
+  return connect();
+}
+
+void ServerPool::release( connection client ){
+  /// hand a healthy connection back to the pool
+  lock_guard<mutex> guard( pool_lock );
+  if ( owner == getpid() && idle.size() < max_idle ){
+    idle.push_back( std::move( client ) );
+  }
+}
+
+bool ServerPool::exchange( Sockets::ClientSocket& client,
+			   const vector<json>& queries,
+			   vector<json>& results ){
+  /// send all queries at once, then read all answers
+  /*!
+    \param client the connection to use
+    \param queries the requests to send
+    \param results the answers, one per request
+    \return false when the connection failed
+  */
+  string out_lines;
+  for ( const auto& q : queries ){
+    out_lines += q.dump() + "\n";
+  }
+  if ( !client.write( out_lines ) ){
+    return false;
+  }
+  results.clear();
+  results.reserve( queries.size() );
+  string line;
+  for ( size_t i=0; i < queries.size(); ++i ){
+    if ( !client.read( line ) ){
+      return false;
+    }
+    results.push_back( parse( line ) );
+  }
+  return true;
+}
+
+vector<json> ServerPool::pipeline( const vector<json>& queries ){
+  /// send a list of requests to the server and return the answers
+  /*!
+    \param queries the JSON requests to send
+    \return the JSON answers, in the same order
+
+    The requests are pipelined: they are all written before the first answer
+    is read. A pooled connection may have been closed by the server in the
+    meantime. In that case we retry once on a fresh connection.
+  */
+  vector<json> results;
+  if ( queries.empty() ){
+    return results;
+  }
+  connection client = acquire();
+  if ( exchange( *client, queries, results ) ){
+    release( std::move( client ) );
+    return results;
+  }
+  client = connect();
+  if ( exchange( *client, queries, results ) ){
+    release( std::move( client ) );
+    return results;
+  }
+  throw runtime_error( "lost connection to " + name() + "\nReason: "
+		       + client->getMessage() );
+}
+
+json ServerPool::call( const json& query ){
+  /// send one request to the server and return the answer
+  vector<json> v = pipeline( vector<json>( 1, query ) );
+  return v[0];
+}
@@ -32,11 +32,11 @@
 #include "frog/tagger_base.h"
 
 #include <algorithm>
-#include "ticcutils/SocketBasics.h"
 #include "ticcutils/PrettyPrint.h"
 #include "ticcutils/Unicode.h"
 #include "ticcutils/json.hpp"
 #include "frog/Frog-util.h"
+#include "frog/server_pool.h"
 
 using namespace std;
 using namespace Tagger;
@@ -323,29 +323,6 @@ vector<TagResult> BaseTagger::json_to_TR( const json& in ) const {
   return result;
 }
 
-json BaseTagger::read_from_client( Sockets::ClientSocket& client ) const {
-  string input_line;
-  client.read( input_line );
-  json response;
-  try {
-    response = json::parse( input_line );
-  }
-  catch ( const exception& e ){
-    LOG << "json parsing failed on '" << input_line << "':"
-	<< e.what() << endl;
-    abort();
-  }
-  DBG << "received json data:" << response << endl;
-  return response;
-}
-
-void BaseTagger::write_to_client( json& j_out,
-				  Sockets::ClientSocket& client ) const {
-  string output_line = j_out.dump() + "\n";
-  DBG << "sending json data:" << output_line << endl;
-  client.write( output_line );
-}
-
 vector<TagResult> BaseTagger::call_server( const vector<tag_entry>& tv ) const {
   /// Connect to a MBT server, send and receive JSON and translate to a
   /// TagResult list
@@ -357,41 +334,15 @@ vector<TagResult> BaseTagger::call_server( const vector<tag_entry>& tv ) const {
     and on succesful receiving back a JSON result we convert it back into
     a TagResult vector
 
-    \note So this is a one-shot operation. No connection to the MBT server is
-    kept open.
+    The connection is taken from the ServerPool for this server and base,
+    so only the first call pays for setting up the connection.
   */
-  Sockets::ClientSocket client;
-  if ( !client.connect( _host, _port ) ){
-    LOG << "failed to open connection, " << _label << "::" << _host
-	<< ":" << _port << endl
-	<< "Reason: " << client.getMessage() << endl;
-    exit( EXIT_FAILURE );
-  }
   DBG << "calling " << _label << "-server, base=" << base << endl;
-  json response = read_from_client( client );
-  if ( response["status"] != "ok" ){
-    LOG << "the client isn't OK" << endl;
-    abort();
-  }
-  if ( !base.empty() ){
-    json out_json;
-    out_json["command"] = "base";
-    out_json["param"] = base;
-    DBG << "created json" << out_json << endl;
-    write_to_client( out_json, client );
-    json base_response = read_from_client( client );
-    if ( base_response["status"] != "ok" ){
-      LOG << "the client isn't OK" << endl;
-      abort();
-    }
-  }
   // create json query struct
   json my_json = create_json( tv );
   DBG << "created json" << my_json << endl;
-  // send it to the server
-  write_to_client( my_json, client );
-  // receive json
-  my_json = read_from_client( client );
+  my_json = ServerPool::get( _host, _port, base )->call( my_json );
+  DBG << "received json data:" << my_json << endl;
   return json_to_TR( my_json );
 }
 
@@ -425,6 +376,7 @@ vector<TagResult> BaseTagger::tagLine( const icu::UnicodeString& line ){
   if ( debug > 1 ){
     DBG << "TAGGING LINE: " << line << endl;
   }
+  lock_guard<mutex> guard( tagger_lock );
   return tagger->TagLine( line );
 }
 
@@ -459,6 +411,7 @@ vector<TagResult> BaseTagger::tag_entries( const vector<tag_entry>& to_do ){
       }
     }
     block += "<utt>\n"; // should use tagger.eosmark??
+    lock_guard<mutex> guard( tagger_lock );
     return tagger->TagLine( block );
   }
 }
@@ -475,6 +428,7 @@ UnicodeString BaseTagger::set_eos_mark( const icu::UnicodeString& eos ){
     return "";
   }
   if ( tagger ){
+    lock_guard<mutex> guard( tagger_lock );
     return tagger->set_eos_mark( eos );
   }
   throw runtime_error( _label + "-tagger is not initialized" );
@@ -520,32 +474,34 @@ void BaseTagger::Classify( frog_data& sent ){
     \param sent the frog_data structure to analyze
 
     When tagging succeeds, 'sent' will be extended with the tag results
+
+    All intermediate results are local, so this function may be called from
+    several threads at once.
    */
-  _words.clear();
   vector<tag_entry> to_do = extract_sentence( sent );
   if ( debug > 1 ){
     DBG << _label << "-tagger in: " << to_do << endl;
   }
-  _tag_result = tag_entries( to_do );
-  if ( _tag_result.size() != sent.size() ){
+  vector<TagResult> tag_result = tag_entries( to_do );
+  if ( tag_result.size() != sent.size() ){
     LOG << _label << "-tagger mismatch between number of words and the tagger result." << endl;
     LOG << "words according to sentence: " << endl;
     for ( size_t w = 0; w < sent.size(); ++w ) {
       LOG << "w[" << w << "]= " << sent.units[w].word << endl;
     }
     LOG << "words according to " << _label << "-tagger: " << endl;
-    for ( size_t i=0; i < _tag_result.size(); ++i ){
-      LOG << "word[" << i << "]=" << _tag_result[i].word() << endl;
+    for ( size_t i=0; i < tag_result.size(); ++i ){
+      LOG << "word[" << i << "]=" << tag_result[i].word() << endl;
     }
     throw runtime_error( _label + "-tagger is confused" );
   }
   if ( debug > 1 ){
     DBG << _label + "-tagger out: " << endl;
-    for ( size_t i=0; i < _tag_result.size(); ++i ){
-      DBG << "[" << i << "] : word=" << _tag_result[i].word()
-	  << " tag=" << _tag_result[i].assigned_tag()
-	  << " confidence=" << _tag_result[i].confidence() << endl;
+    for ( size_t i=0; i < tag_result.size(); ++i ){
+      DBG << "[" << i << "] : word=" << tag_result[i].word()
+	  << " tag=" << tag_result[i].assigned_tag()
+	  << " confidence=" << tag_result[i].confidence() << endl;
     }
   }
-  post_process( sent );
+  post_process( sent, tag_result );
 }
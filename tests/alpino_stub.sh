@@ -0,0 +1,37 @@
+#! /bin/sh
+# a stand-in for a long running Alpino process, used by alpino_pool_test.
+# It reads 'key|sentence' lines and answers with a tiny Alpino XML document,
+# preceded by some noise, like Alpino does. Special sentences:
+#   CRASH : exit without an answer
+#   HANG  : trickle out a byte every second, and never finish
+#   SLOW* : take a second for the answer
+# When ALPINO_STUB_LOG is set, the stub logs its pid at start, and before
+# and after every SLOW sentence, to that file.
+
+log=${ALPINO_STUB_LOG:-/dev/null}
+echo "start $$" >> "$log"
+echo "Alpino stub started"
+while read -r line; do
+  sentence=${line#*|}
+  case "$sentence" in
+    CRASH)
+      exit 1
+      ;;
+    HANG)
+      while true; do
+	printf "x"
+	sleep 1
+      done
+      ;;
+    SLOW*)
+      echo "busy $$" >> "$log"
+      sleep 1
+      echo "idle $$" >> "$log"
+      ;;
+  esac
+  echo "hdrug: parsing $sentence"
+  echo '<?xml version="1.0" encoding="UTF-8"?>'
+  echo '<alpino_ds version="1.3">'
+  echo "  <sentence>$sentence</sentence>"
+  echo '</alpino_ds>'
+done